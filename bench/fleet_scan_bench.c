@@ -0,0 +1,287 @@
+// Benchmark of the fleet distance scans: the array-of-structs loop over the
+// twins that compute_min_distance() used to run, the structure-of-arrays
+// fleet view with the scalar and the AVX2 kernels, and, for the
+// nearest-dispatchable query, the spatial grid the allocator uses.
+//
+// Build and run from the repository root:
+//   gcc -std=c11 -O2 -I. bench/fleet_scan_bench.c bench/fleet_view.c src/runtime/rescuer_grid.c -o fleet_scan_bench
+//   ./fleet_scan_bench [fleet_size ...]
+//
+// Each fleet has BENCH_TYPES rescuer types with random bases on a
+// BENCH_WORLD x BENCH_WORLD map. Half of the units are idle at base, a fifth
+// are returning with up to a minute to go and the rest are busy somewhere
+// on the map. Every variant answers the same random queries; the results
+// are checked against the array-of-structs loop (scores only for the grid,
+// which breaks ties towards units idle at base).
+#define _POSIX_C_SOURCE 200809L
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench/fleet_view.h"
+#include "src/runtime/rescuer_grid.h"
+
+#define BENCH_WORLD 10000
+#define BENCH_TYPES 4
+#define BENCH_NOW 1000
+#define BENCH_SCANNED_UNITS 200000000ULL // per variant, spread over the queries
+#define BENCH_MIN_QUERIES 50
+#define BENCH_MAX_QUERIES 100000
+
+typedef struct bench_query_t {
+    int x;
+    int y;
+    int type_id;
+} bench_query_t;
+
+static uint64_t bench_rng(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static double bench_elapsed_ns(const struct timespec* start, const struct timespec* end) {
+    return (double)(end->tv_sec - start->tv_sec) * 1e9 + (double)(end->tv_nsec - start->tv_nsec);
+}
+
+static int aos_min_distance(const rescuer_digital_twin_t* pool, size_t count, int x, int y) {
+    int min_distance = INT_MAX;
+    for (size_t i = 0; i < count; ++i) {
+        int dx = pool[i].x - x;
+        int dy = pool[i].y - y;
+        int distance = (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+        if (distance < min_distance) {
+            min_distance = distance;
+        }
+    }
+    return min_distance;
+}
+
+static long long nearest_score(const rescuer_digital_twin_t* rescuer, int x, int y, time_t now) {
+    long long dx = (long long)rescuer->x - x;
+    long long dy = (long long)rescuer->y - y;
+    long long score = (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+    if (rescuer->status == RETURNING_TO_BASE && rescuer->return_available_at > now) {
+        score += (long long)(rescuer->return_available_at - now);
+    }
+    return score;
+}
+
+static int aos_nearest(const rescuer_digital_twin_t* pool,
+                       const int* type_ids,
+                       size_t count,
+                       int type_id,
+                       int x,
+                       int y,
+                       time_t now) {
+    int best_index = -1;
+    long long best_score = LLONG_MAX;
+    for (size_t i = 0; i < count; ++i) {
+        if (type_ids[i] != type_id || (pool[i].status != IDLE && pool[i].status != RETURNING_TO_BASE)) {
+            continue;
+        }
+        long long score = nearest_score(&pool[i], x, y, now);
+        if (score < best_score) {
+            best_score = score;
+            best_index = (int)i;
+        }
+    }
+    return best_index;
+}
+
+static void build_fleet(size_t count,
+                        rescuer_type_t* types,
+                        rescuer_digital_twin_t* pool,
+                        int* type_ids,
+                        uint64_t* rng) {
+    for (int t = 0; t < BENCH_TYPES; ++t) {
+        types[t].rescuer_type_name = NULL;
+        types[t].speed = 1;
+        types[t].x = (int)(bench_rng(rng) % BENCH_WORLD);
+        types[t].y = (int)(bench_rng(rng) % BENCH_WORLD);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        int type_id = (int)(bench_rng(rng) % BENCH_TYPES);
+        rescuer_digital_twin_t* rescuer = &pool[i];
+        memset(rescuer, 0, sizeof(*rescuer));
+        rescuer->id = (int)i;
+        rescuer->type = &types[type_id];
+        type_ids[i] = type_id;
+
+        unsigned int roll = (unsigned int)(bench_rng(rng) % 10);
+        if (roll < 5) {
+            rescuer->status = IDLE;
+            rescuer->x = types[type_id].x;
+            rescuer->y = types[type_id].y;
+            continue;
+        }
+        rescuer->status = roll < 7 ? RETURNING_TO_BASE : (rescuer_status_t)(EN_ROUTE_TO_SCENE + roll % 2);
+        rescuer->x = (int)(bench_rng(rng) % BENCH_WORLD);
+        rescuer->y = (int)(bench_rng(rng) % BENCH_WORLD);
+        if (rescuer->status == RETURNING_TO_BASE) {
+            rescuer->return_available_at = BENCH_NOW + (time_t)(bench_rng(rng) % 61);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t default_sizes[] = {100, 1000, 10000, 100000, 1000000};
+    size_t size_count = sizeof(default_sizes) / sizeof(default_sizes[0]);
+    size_t* sizes = default_sizes;
+    size_t custom[16];
+
+    if (argc > 1) {
+        size_count = 0;
+        for (int i = 1; i < argc && size_count < sizeof(custom) / sizeof(custom[0]); ++i) {
+            long value = strtol(argv[i], NULL, 10);
+            if (value <= 0 || value > INT_MAX) {
+                fprintf(stderr, "Invalid fleet size '%s'\n", argv[i]);
+                return 1;
+            }
+            custom[size_count++] = (size_t)value;
+        }
+        sizes = custom;
+    }
+
+    const fleet_kernels_t* scalar = fleet_kernels_scalar();
+    const fleet_kernels_t* avx2 = fleet_kernels_avx2();
+    if (!avx2) {
+        printf("AVX2 not available, the avx2 columns repeat the scalar kernels\n");
+        avx2 = scalar;
+    }
+
+    printf("ns per query; min = min_distance, near = nearest dispatchable unit of a type\n");
+    printf("%9s %8s %10s %10s %10s %8s %10s %10s %10s %10s %8s\n",
+           "fleet", "queries", "min aos", "min soa", "min avx2", "speedup",
+           "near aos", "near soa", "near avx2", "near grid", "speedup");
+
+    for (size_t s = 0; s < size_count; ++s) {
+        size_t count = sizes[s];
+        size_t queries = (size_t)(BENCH_SCANNED_UNITS / count);
+        if (queries < BENCH_MIN_QUERIES) {
+            queries = BENCH_MIN_QUERIES;
+        } else if (queries > BENCH_MAX_QUERIES) {
+            queries = BENCH_MAX_QUERIES;
+        }
+
+        rescuer_type_t types[BENCH_TYPES];
+        rescuer_digital_twin_t* pool = calloc(count, sizeof(rescuer_digital_twin_t));
+        int* type_ids = calloc(count, sizeof(int));
+        bench_query_t* query = calloc(queries, sizeof(bench_query_t));
+        int* expected = calloc(queries, sizeof(int));
+        int* got = calloc(queries, sizeof(int));
+        if (!pool || !type_ids || !query || !expected || !got) {
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+
+        uint64_t rng = 0x9E3779B97F4A7C15ULL ^ count;
+        build_fleet(count, types, pool, type_ids, &rng);
+        for (size_t q = 0; q < queries; ++q) {
+            query[q].x = (int)(bench_rng(&rng) % BENCH_WORLD);
+            query[q].y = (int)(bench_rng(&rng) % BENCH_WORLD);
+            query[q].type_id = (int)(bench_rng(&rng) % BENCH_TYPES);
+        }
+
+        fleet_view_t view;
+        rescuer_grid_t grid;
+        if (fleet_view_init(&view, pool, type_ids, count, 0) != 0 ||
+            rescuer_grid_init(&grid, BENCH_WORLD, BENCH_WORLD, types, BENCH_TYPES, type_ids, count) != 0) {
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (pool[i].status == IDLE || pool[i].status == RETURNING_TO_BASE) {
+                rescuer_grid_place(&grid, (int)i, &pool[i]);
+            }
+        }
+
+        struct timespec start;
+        struct timespec end;
+        double ns[7];
+        int failed = 0;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (size_t q = 0; q < queries; ++q) {
+            expected[q] = aos_min_distance(pool, count, query[q].x, query[q].y);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        ns[0] = bench_elapsed_ns(&start, &end);
+
+        const fleet_kernels_t* min_kernels[2] = {scalar, avx2};
+        for (int k = 0; k < 2; ++k) {
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (size_t q = 0; q < queries; ++q) {
+                got[q] = min_kernels[k]->min_distance(&view, query[q].x, query[q].y);
+            }
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            ns[1 + k] = bench_elapsed_ns(&start, &end);
+            failed |= memcmp(expected, got, queries * sizeof(int)) != 0;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (size_t q = 0; q < queries; ++q) {
+            expected[q] = aos_nearest(pool, type_ids, count, query[q].type_id, query[q].x, query[q].y, BENCH_NOW);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        ns[3] = bench_elapsed_ns(&start, &end);
+
+        for (int k = 0; k < 2; ++k) {
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (size_t q = 0; q < queries; ++q) {
+                got[q] = min_kernels[k]->nearest(&view, query[q].type_id, query[q].x, query[q].y, BENCH_NOW);
+            }
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            ns[4 + k] = bench_elapsed_ns(&start, &end);
+            failed |= memcmp(expected, got, queries * sizeof(int)) != 0;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (size_t q = 0; q < queries; ++q) {
+            got[q] = rescuer_grid_nearest(&grid, query[q].type_id, pool, query[q].x, query[q].y, BENCH_NOW);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        ns[6] = bench_elapsed_ns(&start, &end);
+        for (size_t q = 0; q < queries; ++q) {
+            if ((expected[q] < 0) != (got[q] < 0) ||
+                (expected[q] >= 0 && nearest_score(&pool[expected[q]], query[q].x, query[q].y, BENCH_NOW) !=
+                                         nearest_score(&pool[got[q]], query[q].x, query[q].y, BENCH_NOW))) {
+                failed = 1;
+            }
+        }
+
+        printf("%9zu %8zu %10.1f %10.1f %10.1f %7.1fx %10.1f %10.1f %10.1f %10.1f %7.1fx%s\n",
+               count,
+               queries,
+               ns[0] / (double)queries,
+               ns[1] / (double)queries,
+               ns[2] / (double)queries,
+               ns[2] > 0 ? ns[0] / ns[2] : 0.0,
+               ns[3] / (double)queries,
+               ns[4] / (double)queries,
+               ns[5] / (double)queries,
+               ns[6] / (double)queries,
+               ns[5] > 0 ? ns[3] / ns[5] : 0.0,
+               failed ? "  MISMATCH" : "");
+
+        rescuer_grid_destroy(&grid);
+        fleet_view_destroy(&view);
+        free(pool);
+        free(type_ids);
+        free(query);
+        free(expected);
+        free(got);
+        if (failed) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
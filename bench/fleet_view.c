@@ -0,0 +1,250 @@
+#include "fleet_view.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define FLEET_VIEW_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+int fleet_view_init(fleet_view_t* view,
+                    const rescuer_digital_twin_t* twins,
+                    const int* type_ids,
+                    size_t count,
+                    time_t epoch) {
+    if (!view || (count > 0 && (!twins || !type_ids))) {
+        return -1;
+    }
+
+    memset(view, 0, sizeof(*view));
+    view->count = count;
+    view->epoch = epoch;
+
+    size_t bytes = (count ? count : 1) * sizeof(int32_t);
+    view->x = malloc(bytes);
+    view->y = malloc(bytes);
+    view->type_id = malloc(bytes);
+    view->status = malloc(bytes);
+    view->return_at = malloc(bytes);
+    if (!view->x || !view->y || !view->type_id || !view->status || !view->return_at) {
+        fleet_view_destroy(view);
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        view->type_id[i] = type_ids[i];
+        fleet_view_sync(view, i, &twins[i]);
+    }
+    return 0;
+}
+
+void fleet_view_destroy(fleet_view_t* view) {
+    if (!view) {
+        return;
+    }
+
+    free(view->x);
+    free(view->y);
+    free(view->type_id);
+    free(view->status);
+    free(view->return_at);
+    memset(view, 0, sizeof(*view));
+}
+
+void fleet_view_sync(fleet_view_t* view, size_t index, const rescuer_digital_twin_t* twin) {
+    view->x[index] = twin->x;
+    view->y[index] = twin->y;
+    fleet_view_sync_status(view, index, twin);
+}
+
+void fleet_view_sync_status(fleet_view_t* view, size_t index, const rescuer_digital_twin_t* twin) {
+    view->status[index] = (int32_t)twin->status;
+    view->return_at[index] = twin->return_available_at != 0 ? fleet_view_time(view, twin->return_available_at) : 0;
+}
+
+static int32_t min_distance_scalar(const fleet_view_t* view, int32_t x, int32_t y) {
+    int32_t best = INT32_MAX;
+    for (size_t i = 0; i < view->count; ++i) {
+        int32_t dx = view->x[i] - x;
+        int32_t dy = view->y[i] - y;
+        int32_t distance = (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+        if (distance < best) {
+            best = distance;
+        }
+    }
+    return best;
+}
+
+static int nearest_scalar(const fleet_view_t* view, int32_t type_id, int32_t x, int32_t y, int32_t now) {
+    int best_index = -1;
+    int32_t best_score = INT32_MAX;
+    for (size_t i = 0; i < view->count; ++i) {
+        if (view->type_id[i] != type_id) {
+            continue;
+        }
+        int32_t status = view->status[i];
+        if (status != IDLE && status != RETURNING_TO_BASE) {
+            continue;
+        }
+
+        int32_t dx = view->x[i] - x;
+        int32_t dy = view->y[i] - y;
+        int32_t score = (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+        if (status == RETURNING_TO_BASE && view->return_at[i] > now) {
+            score += view->return_at[i] - now;
+        }
+        if (score < best_score) {
+            best_score = score;
+            best_index = (int)i;
+        }
+    }
+    return best_index;
+}
+
+static const fleet_kernels_t g_scalar_kernels = {
+    .name = "scalar",
+    .min_distance = min_distance_scalar,
+    .nearest = nearest_scalar,
+};
+
+const fleet_kernels_t* fleet_kernels_scalar(void) {
+    return &g_scalar_kernels;
+}
+
+#ifdef FLEET_VIEW_HAVE_AVX2
+
+__attribute__((target("avx2"))) static int32_t min_distance_avx2(const fleet_view_t* view, int32_t x, int32_t y) {
+    const __m256i vx = _mm256_set1_epi32(x);
+    const __m256i vy = _mm256_set1_epi32(y);
+    __m256i best = _mm256_set1_epi32(INT32_MAX);
+
+    size_t i = 0;
+    for (; i + 8 <= view->count; i += 8) {
+        __m256i dx = _mm256_abs_epi32(_mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)&view->x[i]), vx));
+        __m256i dy = _mm256_abs_epi32(_mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)&view->y[i]), vy));
+        best = _mm256_min_epi32(best, _mm256_add_epi32(dx, dy));
+    }
+
+    int32_t lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, best);
+    int32_t result = INT32_MAX;
+    for (int lane = 0; lane < 8; ++lane) {
+        if (lanes[lane] < result) {
+            result = lanes[lane];
+        }
+    }
+
+    for (; i < view->count; ++i) {
+        int32_t dx = view->x[i] - x;
+        int32_t dy = view->y[i] - y;
+        int32_t distance = (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+        if (distance < result) {
+            result = distance;
+        }
+    }
+    return result;
+}
+
+// Each lane keeps its best score and the index it came from; lanes only
+// move to strictly better scores, so each holds its lowest tied index.
+__attribute__((target("avx2"))) static int nearest_avx2(const fleet_view_t* view,
+                                                         int32_t type_id,
+                                                         int32_t x,
+                                                         int32_t y,
+                                                         int32_t now) {
+    const __m256i vx = _mm256_set1_epi32(x);
+    const __m256i vy = _mm256_set1_epi32(y);
+    const __m256i vtype = _mm256_set1_epi32(type_id);
+    const __m256i vnow = _mm256_set1_epi32(now);
+    const __m256i vidle = _mm256_set1_epi32(IDLE);
+    const __m256i vreturning = _mm256_set1_epi32(RETURNING_TO_BASE);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i step = _mm256_set1_epi32(8);
+    __m256i best = _mm256_set1_epi32(INT32_MAX);
+    __m256i best_index = _mm256_set1_epi32(-1);
+    __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    size_t i = 0;
+    for (; i + 8 <= view->count; i += 8) {
+        __m256i status = _mm256_loadu_si256((const __m256i*)&view->status[i]);
+        __m256i returning = _mm256_cmpeq_epi32(status, vreturning);
+        __m256i eligible = _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)&view->type_id[i]), vtype),
+                                            _mm256_or_si256(_mm256_cmpeq_epi32(status, vidle), returning));
+
+        __m256i dx = _mm256_abs_epi32(_mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)&view->x[i]), vx));
+        __m256i dy = _mm256_abs_epi32(_mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)&view->y[i]), vy));
+        __m256i wait = _mm256_max_epi32(_mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)&view->return_at[i]), vnow), zero);
+        __m256i score = _mm256_add_epi32(_mm256_add_epi32(dx, dy), _mm256_and_si256(wait, returning));
+
+        __m256i better = _mm256_and_si256(_mm256_cmpgt_epi32(best, score), eligible);
+        best = _mm256_blendv_epi8(best, score, better);
+        best_index = _mm256_blendv_epi8(best_index, index, better);
+        index = _mm256_add_epi32(index, step);
+    }
+
+    int32_t scores[8];
+    int32_t indices[8];
+    _mm256_storeu_si256((__m256i*)scores, best);
+    _mm256_storeu_si256((__m256i*)indices, best_index);
+    int result = -1;
+    int32_t result_score = INT32_MAX;
+    for (int lane = 0; lane < 8; ++lane) {
+        if (indices[lane] < 0) {
+            continue;
+        }
+        if (result < 0 || scores[lane] < result_score ||
+            (scores[lane] == result_score && indices[lane] < result)) {
+            result_score = scores[lane];
+            result = indices[lane];
+        }
+    }
+
+    // The tail has higher indices than every lane, so strict < keeps ties
+    // on the lowest index.
+    for (; i < view->count; ++i) {
+        if (view->type_id[i] != type_id) {
+            continue;
+        }
+        int32_t status = view->status[i];
+        if (status != IDLE && status != RETURNING_TO_BASE) {
+            continue;
+        }
+        int32_t dx = view->x[i] - x;
+        int32_t dy = view->y[i] - y;
+        int32_t score = (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+        if (status == RETURNING_TO_BASE && view->return_at[i] > now) {
+            score += view->return_at[i] - now;
+        }
+        if (result < 0 || score < result_score) {
+            result_score = score;
+            result = (int)i;
+        }
+    }
+    return result;
+}
+
+static const fleet_kernels_t g_avx2_kernels = {
+    .name = "avx2",
+    .min_distance = min_distance_avx2,
+    .nearest = nearest_avx2,
+};
+
+const fleet_kernels_t* fleet_kernels_avx2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? &g_avx2_kernels : NULL;
+}
+
+#else
+
+const fleet_kernels_t* fleet_kernels_avx2(void) {
+    return NULL;
+}
+
+#endif
+
+const fleet_kernels_t* fleet_kernels_select(void) {
+    const fleet_kernels_t* kernels = fleet_kernels_avx2();
+    return kernels ? kernels : fleet_kernels_scalar();
+}
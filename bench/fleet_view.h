@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "../rescuers.h"
+
+// Structure-of-arrays copy of the fields the dispatcher scans, so distance
+// kernels stream through dense int32 arrays instead of whole twins. Return
+// times are stored relative to epoch, with 0 meaning "not returning".
+typedef struct fleet_view_t {
+    size_t count;
+    time_t epoch;
+    int32_t* x;
+    int32_t* y;
+    int32_t* type_id;   // rescuer type ID, -1 if the type is not indexed
+    int32_t* status;    // rescuer_status_t
+    int32_t* return_at; // return_available_at - epoch
+} fleet_view_t;
+
+// type_ids gives the rescuer type ID of every twin.
+int fleet_view_init(fleet_view_t* view,
+                    const rescuer_digital_twin_t* twins,
+                    const int* type_ids,
+                    size_t count,
+                    time_t epoch);
+void fleet_view_destroy(fleet_view_t* view);
+
+// Copies position, status and return time of one twin into the view.
+void fleet_view_sync(fleet_view_t* view, size_t index, const rescuer_digital_twin_t* twin);
+// Copies only status and return time, leaving the position alone.
+void fleet_view_sync_status(fleet_view_t* view, size_t index, const rescuer_digital_twin_t* twin);
+
+static inline int32_t fleet_view_time(const fleet_view_t* view, time_t when) {
+    long long offset = (long long)(when - view->epoch);
+    if (offset > INT32_MAX) {
+        return INT32_MAX;
+    }
+    return offset < INT32_MIN ? INT32_MIN : (int32_t)offset;
+}
+
+// Distance kernels. Coordinates and scores must fit in int32.
+typedef struct fleet_kernels_t {
+    const char* name;
+    // Smallest Manhattan distance from (x, y) to any unit, INT32_MAX if
+    // the view is empty.
+    int32_t (*min_distance)(const fleet_view_t* view, int32_t x, int32_t y);
+    // Index of the IDLE or RETURNING_TO_BASE unit of the given type that
+    // minimises distance plus the seconds it still needs to get back to
+    // base (now relative to the epoch), lowest index on ties; -1 if none.
+    int (*nearest)(const fleet_view_t* view, int32_t type_id, int32_t x, int32_t y, int32_t now);
+} fleet_kernels_t;
+
+const fleet_kernels_t* fleet_kernels_scalar(void);
+// NULL when the build or the CPU lacks AVX2.
+const fleet_kernels_t* fleet_kernels_avx2(void);
+// AVX2 kernels when available, the scalar ones otherwise.
+const fleet_kernels_t* fleet_kernels_select(void);
@@ -0,0 +1,185 @@
+// Microbenchmark for mq_message_parse().
+//
+// Build and run from the repository root:
+//   gcc -std=c11 -O2 -I. bench/mq_parse_bench.c mq_message.c -o mq_parse_bench
+//   ./mq_parse_bench bench/mq_parse_corpus.txt [iterations]
+//
+// Every corpus line is "<expected status>|<message>". The corpus is first
+// checked against the expected statuses, then parsed in a loop to report
+// messages parsed per second. The valid lines are also encoded in the
+// binary format and decoded in a second loop for comparison.
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mq_message.h"
+
+#define BENCH_MAX_LINES 4096
+#define BENCH_DEFAULT_ITERATIONS 200000
+#define BENCH_FIXED_NOW ((time_t)1800000000)
+
+typedef struct corpus_entry_t {
+    char* message;
+    size_t length;
+    mq_parse_status_t expected;
+} corpus_entry_t;
+
+static int status_from_string(const char* name, mq_parse_status_t* out_status) {
+    for (int i = 0; i < MQ_PARSE_STATUS_COUNT; ++i) {
+        if (strcmp(name, mq_parse_status_to_string((mq_parse_status_t)i)) == 0) {
+            *out_status = (mq_parse_status_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static size_t load_corpus(const char* path, corpus_entry_t* entries, size_t max_entries) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        perror("Errore nell'apertura del corpus");
+        return 0;
+    }
+
+    char* line = NULL;
+    size_t len = 0;
+    ssize_t read;
+    size_t count = 0;
+
+    while ((read = getline(&line, &len, file)) != -1 && count < max_entries) {
+        if (read > 0 && line[read - 1] == '\n') {
+            line[--read] = '\0';
+        }
+        if (read == 0 || line[0] == '#') {
+            continue;
+        }
+
+        char* separator = strchr(line, '|');
+        if (!separator) {
+            fprintf(stderr, "Skipping malformed corpus line: %s\n", line);
+            continue;
+        }
+        *separator = '\0';
+
+        corpus_entry_t* entry = &entries[count];
+        if (status_from_string(line, &entry->expected) != 0) {
+            fprintf(stderr, "Unknown status '%s' in corpus\n", line);
+            continue;
+        }
+
+        entry->length = strlen(separator + 1);
+        entry->message = malloc(entry->length + 1);
+        if (!entry->message) {
+            break;
+        }
+        memcpy(entry->message, separator + 1, entry->length + 1);
+        ++count;
+    }
+
+    free(line);
+    fclose(file);
+    return count;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <corpus> [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    long iterations = argc > 2 ? atol(argv[2]) : BENCH_DEFAULT_ITERATIONS;
+    if (iterations <= 0) {
+        iterations = BENCH_DEFAULT_ITERATIONS;
+    }
+
+    static corpus_entry_t entries[BENCH_MAX_LINES];
+    size_t count = load_corpus(argv[1], entries, BENCH_MAX_LINES);
+    if (count == 0) {
+        fprintf(stderr, "Empty corpus\n");
+        return EXIT_FAILURE;
+    }
+
+    const mq_parse_limits_t limits = {.grid_width = 400, .grid_height = 300, .now = BENCH_FIXED_NOW};
+    emergency_request_t request;
+    int mismatches = 0;
+    size_t valid = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        mq_parse_status_t status = mq_message_parse(entries[i].message, entries[i].length, &limits, &request);
+        if (status != entries[i].expected) {
+            fprintf(stderr,
+                    "Mismatch for '%s': expected %s, got %s\n",
+                    entries[i].message,
+                    mq_parse_status_to_string(entries[i].expected),
+                    mq_parse_status_to_string(status));
+            ++mismatches;
+        }
+        if (status == MQ_PARSE_OK) {
+            ++valid;
+        }
+    }
+
+    struct timespec start;
+    struct timespec end;
+    volatile unsigned long sink = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long it = 0; it < iterations; ++it) {
+        for (size_t i = 0; i < count; ++i) {
+            sink += (unsigned long)mq_message_parse(entries[i].message, entries[i].length, &limits, &request);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double elapsed = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+    double total = (double)iterations * (double)count;
+
+    printf("corpus=%zu lines (%zu valid, %zu malformed) mismatches=%d\n", count, valid, count - valid, mismatches);
+    printf("parsed %.0f messages in %.3fs: %.2f M msg/s, %.1f ns/msg\n",
+           total,
+           elapsed,
+           elapsed > 0.0 ? total / elapsed / 1e6 : 0.0,
+           total > 0.0 ? elapsed * 1e9 / total : 0.0);
+
+    static unsigned char binary[BENCH_MAX_LINES][MQ_MESSAGE_BINARY_SIZE];
+    size_t binary_count = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (mq_message_parse(entries[i].message, entries[i].length, &limits, &request) == MQ_PARSE_OK) {
+            mq_message_encode_binary(0, request.x, request.y, (int64_t)request.timestamp, binary[binary_count++]);
+        }
+    }
+
+    if (binary_count > 0) {
+        mq_parse_limits_t binary_limits = limits;
+        binary_limits.type_count = 1;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (long it = 0; it < iterations; ++it) {
+            for (size_t i = 0; i < binary_count; ++i) {
+                sink += (unsigned long)mq_message_decode((const char*)binary[i],
+                                                         MQ_MESSAGE_BINARY_SIZE,
+                                                         &binary_limits,
+                                                         &request);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        elapsed = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+        total = (double)iterations * (double)binary_count;
+        printf("decoded %.0f binary messages in %.3fs: %.2f M msg/s, %.1f ns/msg\n",
+               total,
+               elapsed,
+               elapsed > 0.0 ? total / elapsed / 1e6 : 0.0,
+               total > 0.0 ? elapsed * 1e9 / total : 0.0);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        free(entries[i].message);
+    }
+
+    (void)sink;
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
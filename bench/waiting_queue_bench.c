@@ -0,0 +1,227 @@
+// Benchmark of the waiting heap against the sorted array it replaced.
+//
+// Build and run from the repository root:
+//   gcc -std=c11 -O2 -I. bench/waiting_queue_bench.c src/runtime/waiting_heap.c -o waiting_queue_bench
+//   ./waiting_queue_bench [backlog ...]
+//
+// For each backlog size the queue is filled with random scores and then put
+// through a steady-state mix of operations, one third each: dispatch (pop
+// the best record and admit a new one), aging (raise a random record's score
+// and reposition it) and timeout (remove a random record and admit a new
+// one). The array variant reproduces the old insertion sort / memmove code;
+// both variants replay the same random operation sequence, and the final
+// drain of each is checked to come out in priority order.
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "src/runtime/state.h"
+#include "src/runtime/waiting_heap.h"
+
+#define BENCH_DEFAULT_OPERATIONS 200000
+#define BENCH_AGING_BOOST 100000
+
+typedef struct sorted_array_t {
+    emergency_record_t** items;
+    size_t count;
+} sorted_array_t;
+
+static void array_insert(sorted_array_t* array, emergency_record_t* record) {
+    size_t idx = array->count;
+    while (idx > 0 && array->items[idx - 1]->priority_score < record->priority_score) {
+        array->items[idx] = array->items[idx - 1];
+        --idx;
+    }
+    array->items[idx] = record;
+    array->count++;
+}
+
+static emergency_record_t* array_remove_index(sorted_array_t* array, size_t index) {
+    emergency_record_t* record = array->items[index];
+    memmove(&array->items[index], &array->items[index + 1], (array->count - index - 1) * sizeof(emergency_record_t*));
+    array->count--;
+    return record;
+}
+
+static uint64_t bench_rng(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static int bench_score(uint64_t* rng) {
+    // Three priority bands minus a distance, like update_record_priority_locked().
+    return (int)(bench_rng(rng) % 3) * 100000 - (int)(bench_rng(rng) % 700);
+}
+
+static double bench_elapsed_ns(const struct timespec* start, const struct timespec* end) {
+    return (double)(end->tv_sec - start->tv_sec) * 1e9 + (double)(end->tv_nsec - start->tv_nsec);
+}
+
+// Runs the workload on one variant. pops[] receives every popped score and
+// *out_popped their number.
+static double run_array(size_t backlog, size_t operations, emergency_record_t* pool, int* pops, size_t* out_popped) {
+    sorted_array_t array = {.items = calloc(backlog + 1, sizeof(emergency_record_t*)), .count = 0};
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    size_t next = 0;
+    size_t popped = 0;
+
+    for (size_t i = 0; i < backlog; ++i) {
+        pool[next].priority_score = bench_score(&rng);
+        array_insert(&array, &pool[next++]);
+    }
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t op = 0; op < operations; ++op) {
+        uint64_t pick = bench_rng(&rng);
+        size_t index = (size_t)(bench_rng(&rng) % array.count);
+        switch (pick % 3) {
+            case 0:
+                pops[popped++] = array_remove_index(&array, 0)->priority_score;
+                break;
+            case 1: {
+                emergency_record_t* record = array_remove_index(&array, index);
+                record->priority_score += BENCH_AGING_BOOST;
+                array_insert(&array, record);
+                continue;
+            }
+            default:
+                array_remove_index(&array, index);
+                break;
+        }
+        pool[next].priority_score = bench_score(&rng);
+        array_insert(&array, &pool[next++]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    while (array.count > 0) {
+        pops[popped++] = array_remove_index(&array, 0)->priority_score;
+    }
+    free(array.items);
+    *out_popped = popped;
+    return bench_elapsed_ns(&start, &end);
+}
+
+static double run_heap(size_t backlog, size_t operations, emergency_record_t* pool, int* pops, size_t* out_popped) {
+    waiting_heap_t heap;
+    waiting_heap_init(&heap);
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    size_t next = 0;
+    size_t popped = 0;
+
+    for (size_t i = 0; i < backlog; ++i) {
+        pool[next].priority_score = bench_score(&rng);
+        waiting_heap_push(&heap, &pool[next++]);
+    }
+
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t op = 0; op < operations; ++op) {
+        uint64_t pick = bench_rng(&rng);
+        // Same random stream as the array run; any queued record will do as
+        // the target, so take the one stored at that heap slot.
+        emergency_record_t* target = heap.items[bench_rng(&rng) % heap.count];
+        switch (pick % 3) {
+            case 0:
+                pops[popped++] = waiting_heap_pop(&heap)->priority_score;
+                break;
+            case 1:
+                target->priority_score += BENCH_AGING_BOOST;
+                waiting_heap_update(&heap, target);
+                continue;
+            default:
+                waiting_heap_remove(&heap, target);
+                break;
+        }
+        pool[next].priority_score = bench_score(&rng);
+        waiting_heap_push(&heap, &pool[next++]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    while (waiting_heap_count(&heap) > 0) {
+        pops[popped++] = waiting_heap_pop(&heap)->priority_score;
+    }
+    waiting_heap_destroy(&heap);
+    *out_popped = popped;
+    return bench_elapsed_ns(&start, &end);
+}
+
+// Popped scores must never increase between two pops with nothing admitted
+// in between; checking the final drain is enough to catch a broken order.
+static int check_drain(const int* pops, size_t total, size_t backlog) {
+    for (size_t i = total - backlog + 1; i < total; ++i) {
+        if (pops[i] > pops[i - 1]) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    size_t default_backlogs[] = {100, 1000, 10000, 50000};
+    size_t backlog_count = sizeof(default_backlogs) / sizeof(default_backlogs[0]);
+    size_t* backlogs = default_backlogs;
+    size_t custom[16];
+
+    if (argc > 1) {
+        backlog_count = 0;
+        for (int i = 1; i < argc && backlog_count < sizeof(custom) / sizeof(custom[0]); ++i) {
+            long value = strtol(argv[i], NULL, 10);
+            if (value <= 0) {
+                fprintf(stderr, "Invalid backlog '%s'\n", argv[i]);
+                return 1;
+            }
+            custom[backlog_count++] = (size_t)value;
+        }
+        backlogs = custom;
+    }
+
+    printf("%10s %10s %14s %14s %8s\n", "backlog", "ops", "array ns/op", "heap ns/op", "speedup");
+    for (size_t b = 0; b < backlog_count; ++b) {
+        size_t backlog = backlogs[b];
+        size_t operations = BENCH_DEFAULT_OPERATIONS;
+        size_t records = backlog + operations;
+
+        emergency_record_t* pool = calloc(records, sizeof(emergency_record_t));
+        int* array_pops = calloc(records, sizeof(int));
+        int* heap_pops = calloc(records, sizeof(int));
+        if (!pool || !array_pops || !heap_pops) {
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+
+        size_t array_popped = 0;
+        size_t heap_popped = 0;
+        double array_ns = run_array(backlog, operations, pool, array_pops, &array_popped);
+        memset(pool, 0, records * sizeof(emergency_record_t));
+        double heap_ns = run_heap(backlog, operations, pool, heap_pops, &heap_popped);
+
+        if (check_drain(array_pops, array_popped, backlog) != 0 || check_drain(heap_pops, heap_popped, backlog) != 0) {
+            fprintf(stderr, "Queue order violated for backlog %zu\n", backlog);
+            return 1;
+        }
+
+        printf("%10zu %10zu %14.1f %14.1f %7.1fx\n",
+               backlog,
+               operations,
+               array_ns / (double)operations,
+               heap_ns / (double)operations,
+               array_ns / heap_ns);
+
+        free(heap_pops);
+        free(array_pops);
+        free(pool);
+    }
+
+    return 0;
+}
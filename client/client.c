@@ -0,0 +1,706 @@
+// Client for the emergency server: sends single requests, replays request
+// files and generates open-loop load.
+//
+// Build from the repository root:
+//   gcc -std=c11 -O2 -pthread -I. client/client.c mq_message.c parse_env.c logging.c -o client -lrt -lm
+//
+// Usage:
+//   ./client <name> <x> <y> <delay_in_secs>
+//   ./client -f <file>                       (lines "<name> <x> <y> <delay_in_secs>")
+//   ./client -g -m <mix> [options]           (load generator)
+//
+// Generator options:
+//   -m Incendio:3,Allagamento:1   type mix with integer weights (weight defaults to 1);
+//                                  with -b every name is a binary type ID (see MQ-TYPE-ID)
+//   -r <msgs/s>                   target rate (default 10000)
+//   -a poisson|constant           arrival process (default poisson)
+//   -d <secs> | -n <count>        stop after a duration (default 10 s) or a message count
+//   -s uniform|hotspot:x,y,sigma  spatial distribution over the grid (default uniform)
+//   -b                            send the binary format instead of text
+//   -S <seed>                     random seed (default: time based)
+//
+// Common options: -q <queue> overrides the queue from environment.txt and
+// -e <path> reads another environment file. With mq_shards > 1 each request
+// goes to the shard that owns its x band.
+//
+// Queues are opened non-blocking. Arrivals are scheduled against absolute
+// CLOCK_MONOTONIC deadlines, so a full queue delays the messages behind it
+// without shifting the schedule; stalls, time spent on a full queue and
+// lateness against the schedule are reported at the end.
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <mqueue.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "emergency.h"
+#include "logging.h"
+#include "mq_consumer.h"
+#include "mq_message.h"
+#include "parse_env.h"
+
+#define CLIENT_DEFAULT_RATE 10000.0
+#define CLIENT_DEFAULT_DURATION 10.0
+#define CLIENT_MAX_MIX 64
+#define CLIENT_MAX_QUEUE_NAME 255
+#define CLIENT_MESSAGE_SIZE 128
+
+// Deadlines closer than this are reached by spinning instead of sleeping,
+// since clock_nanosleep usually overshoots by tens of microseconds.
+#define CLIENT_SPIN_NS 50000ULL
+
+// Back-off between retries while the queue is full.
+#define CLIENT_FULL_BACKOFF_NS 20000L
+
+#define NSEC_PER_SEC 1000000000ULL
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+typedef enum client_arrivals_t {
+    CLIENT_ARRIVALS_POISSON = 0,
+    CLIENT_ARRIVALS_CONSTANT
+} client_arrivals_t;
+
+typedef struct client_mix_entry_t {
+    char name[EMERGENCY_NAME_LENGTH];
+    int type_id;
+    unsigned int cumulative_weight;
+} client_mix_entry_t;
+
+typedef struct client_stats_t {
+    unsigned long long sent;
+    unsigned long long errors;
+    unsigned long long stalls;       // mq_send calls that returned EAGAIN
+    unsigned long long full_ns;      // time spent waiting on a full queue
+    unsigned long long late_total_ns;
+    unsigned long long late_max_ns;
+} client_stats_t;
+
+typedef struct client_t {
+    mqd_t queues[MQ_CONSUMER_MAX_SHARDS];
+    size_t shard_count;
+    int width;
+    int height;
+    bool binary;
+    client_stats_t stats;
+} client_t;
+
+typedef struct client_generator_t {
+    client_mix_entry_t mix[CLIENT_MAX_MIX];
+    size_t mix_count;
+    double rate;
+    client_arrivals_t arrivals;
+    double duration;
+    unsigned long long count;
+    bool hotspot;
+    double hotspot_x;
+    double hotspot_y;
+    double hotspot_sigma;
+    uint64_t rng;
+} client_generator_t;
+
+typedef struct client_file_entry_t {
+    char name[EMERGENCY_NAME_LENGTH];
+    int x;
+    int y;
+    double delay;
+    size_t line;
+} client_file_entry_t;
+
+static uint64_t client_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static void client_wait_until(uint64_t deadline_ns) {
+    for (;;) {
+        uint64_t now = client_now_ns();
+        if (now >= deadline_ns) {
+            return;
+        }
+
+        if (deadline_ns - now > CLIENT_SPIN_NS) {
+            uint64_t wake = deadline_ns - CLIENT_SPIN_NS;
+            struct timespec ts = {
+                .tv_sec = (time_t)(wake / NSEC_PER_SEC),
+                .tv_nsec = (long)(wake % NSEC_PER_SEC),
+            };
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        }
+    }
+}
+
+// xorshift64*: fast and good enough for arrival times and coordinates.
+static uint64_t client_rng_next(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+// Uniform in (0, 1].
+static double client_rng_unit(uint64_t* state) {
+    return ((double)(client_rng_next(state) >> 11) + 1.0) * 0x1.0p-53;
+}
+
+static void client_usage(const char* program) {
+    fprintf(stderr,
+            "Usage:\n"
+            "  %s <name> <x> <y> <delay_in_secs>\n"
+            "  %s -f <file>\n"
+            "  %s -g -m <name[:weight],...> [-r rate] [-a poisson|constant] [-d secs | -n count]\n"
+            "     [-s uniform|hotspot:x,y,sigma] [-b] [-S seed]\n"
+            "Common options: [-q queue] [-e environment_file]\n",
+            program,
+            program,
+            program);
+}
+
+static int client_open(client_t* client, const char* base_name, size_t shard_count) {
+    client->shard_count = shard_count;
+
+    for (size_t i = 0; i < shard_count; ++i) {
+        client->queues[i] = (mqd_t)-1;
+    }
+
+    const char* slash = base_name[0] == '/' ? "" : "/";
+    for (size_t i = 0; i < shard_count; ++i) {
+        char name[CLIENT_MAX_QUEUE_NAME + 1];
+        int written;
+        if (shard_count > 1) {
+            written = snprintf(name, sizeof(name), "%s%s.%zu", slash, base_name, i);
+        } else {
+            written = snprintf(name, sizeof(name), "%s%s", slash, base_name);
+        }
+        if (written < 0 || (size_t)written >= sizeof(name)) {
+            fprintf(stderr, "Queue name '%s' is too long.\n", base_name);
+            return -1;
+        }
+
+        client->queues[i] = mq_open(name, O_WRONLY | O_NONBLOCK);
+        if (client->queues[i] == (mqd_t)-1) {
+            fprintf(stderr, "Failed to open queue '%s': %s\n", name, strerror(errno));
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static void client_close(client_t* client) {
+    for (size_t i = 0; i < client->shard_count; ++i) {
+        if (client->queues[i] != (mqd_t)-1) {
+            mq_close(client->queues[i]);
+            client->queues[i] = (mqd_t)-1;
+        }
+    }
+}
+
+static size_t client_shard_for(const client_t* client, int x) {
+    if (client->shard_count <= 1 || client->width <= 0 || x < 0) {
+        return 0;
+    }
+
+    size_t shard = (size_t)x * client->shard_count / (size_t)client->width;
+    return shard < client->shard_count ? shard : client->shard_count - 1;
+}
+
+// Sends one message, retrying while the queue is full. Returns 0 on success.
+static int client_send(client_t* client, const char* name, int type_id, int x, int y) {
+    char buffer[CLIENT_MESSAGE_SIZE];
+    size_t length;
+    time_t timestamp = time(NULL);
+
+    if (client->binary) {
+        length = mq_message_encode_binary((uint16_t)type_id, x, y, (int64_t)timestamp, (unsigned char*)buffer);
+    } else {
+        int written = snprintf(buffer, sizeof(buffer), "%s;%d;%d;%ld", name, x, y, (long)timestamp);
+        if (written < 0 || (size_t)written >= sizeof(buffer)) {
+            client->stats.errors++;
+            return -1;
+        }
+        length = (size_t)written;
+    }
+
+    mqd_t queue = client->queues[client_shard_for(client, x)];
+    uint64_t full_since = 0;
+
+    for (;;) {
+        if (mq_send(queue, buffer, length, 0) == 0) {
+            break;
+        }
+
+        if (errno == EINTR) {
+            continue;
+        }
+
+        if (errno != EAGAIN) {
+            fprintf(stderr, "mq_send failed: %s\n", strerror(errno));
+            client->stats.errors++;
+            return -1;
+        }
+
+        client->stats.stalls++;
+        if (full_since == 0) {
+            full_since = client_now_ns();
+        }
+        struct timespec backoff = {.tv_sec = 0, .tv_nsec = CLIENT_FULL_BACKOFF_NS};
+        nanosleep(&backoff, NULL);
+    }
+
+    if (full_since != 0) {
+        client->stats.full_ns += client_now_ns() - full_since;
+    }
+    client->stats.sent++;
+    return 0;
+}
+
+static void client_record_lateness(client_t* client, uint64_t deadline_ns) {
+    uint64_t now = client_now_ns();
+    if (now <= deadline_ns) {
+        return;
+    }
+
+    uint64_t late = now - deadline_ns;
+    client->stats.late_total_ns += late;
+    if (late > client->stats.late_max_ns) {
+        client->stats.late_max_ns = late;
+    }
+}
+
+static void client_report(const client_t* client, uint64_t elapsed_ns, double target_rate) {
+    double elapsed = (double)elapsed_ns / (double)NSEC_PER_SEC;
+    double achieved = elapsed > 0.0 ? (double)client->stats.sent / elapsed : 0.0;
+    double full_ms = (double)client->stats.full_ns / 1e6;
+    double late_mean_us = client->stats.sent > 0 ? (double)client->stats.late_total_ns / (double)client->stats.sent / 1e3 : 0.0;
+
+    printf("sent=%llu errors=%llu elapsed=%.3fs\n", client->stats.sent, client->stats.errors, elapsed);
+    if (target_rate > 0.0) {
+        printf("rate: target=%.0f msg/s achieved=%.0f msg/s (%.1f%%)\n",
+               target_rate,
+               achieved,
+               100.0 * achieved / target_rate);
+    } else {
+        printf("rate: achieved=%.0f msg/s\n", achieved);
+    }
+    printf("queue full: EAGAIN stalls=%llu time=%.3fms (%.2f%% of run)\n",
+           client->stats.stalls,
+           full_ms,
+           elapsed > 0.0 ? 100.0 * full_ms / (elapsed * 1e3) : 0.0);
+    printf("lateness vs schedule: mean=%.1fus max=%.1fus\n", late_mean_us, (double)client->stats.late_max_ns / 1e3);
+}
+
+static int client_parse_mix(const char* spec, bool binary, client_generator_t* generator) {
+    char* copy = strdup(spec);
+    if (!copy) {
+        return -1;
+    }
+
+    int result = 0;
+    unsigned int total = 0;
+    char* saveptr = NULL;
+    for (char* item = strtok_r(copy, ",", &saveptr); item; item = strtok_r(NULL, ",", &saveptr)) {
+        if (generator->mix_count >= CLIENT_MAX_MIX) {
+            fprintf(stderr, "Too many entries in the type mix (max %d).\n", CLIENT_MAX_MIX);
+            result = -1;
+            break;
+        }
+
+        unsigned int weight = 1;
+        char* colon = strrchr(item, ':');
+        if (colon) {
+            *colon = '\0';
+            char* end = NULL;
+            long parsed = strtol(colon + 1, &end, 10);
+            if (!end || *end != '\0' || parsed <= 0) {
+                fprintf(stderr, "Invalid weight in mix entry '%s'.\n", item);
+                result = -1;
+                break;
+            }
+            weight = (unsigned int)parsed;
+        }
+
+        client_mix_entry_t* entry = &generator->mix[generator->mix_count];
+        if (item[0] == '\0' || strlen(item) >= sizeof(entry->name)) {
+            fprintf(stderr, "Invalid type name in mix.\n");
+            result = -1;
+            break;
+        }
+        strcpy(entry->name, item);
+        entry->type_id = -1;
+
+        if (binary) {
+            char* end = NULL;
+            long id = strtol(item, &end, 10);
+            if (!end || *end != '\0' || id < 0 || id > UINT16_MAX) {
+                fprintf(stderr, "Binary mode needs numeric type IDs in the mix, got '%s'.\n", item);
+                result = -1;
+                break;
+            }
+            entry->type_id = (int)id;
+        }
+
+        total += weight;
+        entry->cumulative_weight = total;
+        generator->mix_count++;
+    }
+
+    free(copy);
+    if (result == 0 && generator->mix_count == 0) {
+        fprintf(stderr, "The type mix is empty.\n");
+        result = -1;
+    }
+    return result;
+}
+
+static int client_parse_spatial(const char* spec, client_generator_t* generator) {
+    if (strcmp(spec, "uniform") == 0) {
+        generator->hotspot = false;
+        return 0;
+    }
+
+    if (sscanf(spec, "hotspot:%lf,%lf,%lf", &generator->hotspot_x, &generator->hotspot_y, &generator->hotspot_sigma) == 3 &&
+        generator->hotspot_sigma > 0.0) {
+        generator->hotspot = true;
+        return 0;
+    }
+
+    fprintf(stderr, "Invalid spatial distribution '%s'.\n", spec);
+    return -1;
+}
+
+static const client_mix_entry_t* client_pick_type(client_generator_t* generator) {
+    unsigned int total = generator->mix[generator->mix_count - 1].cumulative_weight;
+    unsigned int pick = (unsigned int)(client_rng_next(&generator->rng) % total);
+    for (size_t i = 0; i < generator->mix_count; ++i) {
+        if (pick < generator->mix[i].cumulative_weight) {
+            return &generator->mix[i];
+        }
+    }
+    return &generator->mix[generator->mix_count - 1];
+}
+
+static int client_clamp(double value, int limit) {
+    if (value < 0.0) {
+        return 0;
+    }
+    if (value >= (double)limit) {
+        return limit - 1;
+    }
+    return (int)value;
+}
+
+static void client_pick_position(const client_t* client, client_generator_t* generator, int* x, int* y) {
+    if (!generator->hotspot) {
+        *x = (int)(client_rng_next(&generator->rng) % (uint64_t)client->width);
+        *y = (int)(client_rng_next(&generator->rng) % (uint64_t)client->height);
+        return;
+    }
+
+    // Box-Muller: two independent normal samples around the hotspot.
+    double u1 = client_rng_unit(&generator->rng);
+    double u2 = client_rng_unit(&generator->rng);
+    double radius = sqrt(-2.0 * log(u1)) * generator->hotspot_sigma;
+    double angle = 2.0 * M_PI * u2;
+    *x = client_clamp(generator->hotspot_x + radius * cos(angle), client->width);
+    *y = client_clamp(generator->hotspot_y + radius * sin(angle), client->height);
+}
+
+static int client_run_generator(client_t* client, client_generator_t* generator) {
+    const double mean_gap_ns = (double)NSEC_PER_SEC / generator->rate;
+    const uint64_t duration_ns = generator->count > 0 ? 0 : (uint64_t)(generator->duration * (double)NSEC_PER_SEC);
+
+    uint64_t start = client_now_ns();
+    double offset_ns = 0.0;
+
+    for (unsigned long long i = 0;; ++i) {
+        if (generator->count > 0 ? i >= generator->count : (uint64_t)offset_ns >= duration_ns) {
+            break;
+        }
+
+        uint64_t deadline = start + (uint64_t)offset_ns;
+        client_wait_until(deadline);
+        client_record_lateness(client, deadline);
+
+        const client_mix_entry_t* type = client_pick_type(generator);
+        int x;
+        int y;
+        client_pick_position(client, generator, &x, &y);
+        client_send(client, type->name, type->type_id, x, y);
+
+        if (generator->arrivals == CLIENT_ARRIVALS_POISSON) {
+            offset_ns += -log(client_rng_unit(&generator->rng)) * mean_gap_ns;
+        } else {
+            offset_ns += mean_gap_ns;
+        }
+    }
+
+    client_report(client, client_now_ns() - start, generator->rate);
+    return client->stats.errors == 0 ? 0 : 1;
+}
+
+static int client_compare_entries(const void* a, const void* b) {
+    const client_file_entry_t* lhs = a;
+    const client_file_entry_t* rhs = b;
+    if (lhs->delay != rhs->delay) {
+        return lhs->delay < rhs->delay ? -1 : 1;
+    }
+    return lhs->line < rhs->line ? -1 : (lhs->line > rhs->line);
+}
+
+// Each delay is an offset from the start of the replay; entries are sent in
+// delay order, ties in file order.
+static int client_run_file(client_t* client, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Failed to open '%s': %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    client_file_entry_t* entries = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    char* line = NULL;
+    size_t line_capacity = 0;
+    size_t line_number = 0;
+    int result = 0;
+
+    while (getline(&line, &line_capacity, file) != -1) {
+        ++line_number;
+        char* p = line;
+        while (*p == ' ' || *p == '\t') {
+            ++p;
+        }
+        if (*p == '\0' || *p == '\n' || *p == '#') {
+            continue;
+        }
+
+        if (count == capacity) {
+            size_t new_capacity = capacity ? capacity * 2 : 64;
+            client_file_entry_t* grown = realloc(entries, new_capacity * sizeof(*entries));
+            if (!grown) {
+                fprintf(stderr, "Out of memory reading '%s'.\n", path);
+                result = 1;
+                break;
+            }
+            entries = grown;
+            capacity = new_capacity;
+        }
+
+        client_file_entry_t* entry = &entries[count];
+        char extra;
+        if (sscanf(p, "%63s %d %d %lf %c", entry->name, &entry->x, &entry->y, &entry->delay, &extra) != 4 ||
+            entry->delay < 0.0) {
+            fprintf(stderr, "%s:%zu: expected '<name> <x> <y> <delay>'\n", path, line_number);
+            result = 1;
+            break;
+        }
+        entry->line = line_number;
+        ++count;
+    }
+
+    free(line);
+    fclose(file);
+
+    if (result == 0) {
+        qsort(entries, count, sizeof(*entries), client_compare_entries);
+
+        uint64_t start = client_now_ns();
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t deadline = start + (uint64_t)(entries[i].delay * (double)NSEC_PER_SEC);
+            client_wait_until(deadline);
+            client_record_lateness(client, deadline);
+            client_send(client, entries[i].name, -1, entries[i].x, entries[i].y);
+        }
+
+        client_report(client, client_now_ns() - start, 0.0);
+        result = client->stats.errors == 0 ? 0 : 1;
+    }
+
+    free(entries);
+    return result;
+}
+
+static int client_run_single(client_t* client, char** argv) {
+    char* end = NULL;
+    long x = strtol(argv[1], &end, 10);
+    if (*end != '\0') {
+        fprintf(stderr, "Invalid x coordinate '%s'.\n", argv[1]);
+        return 1;
+    }
+    long y = strtol(argv[2], &end, 10);
+    if (*end != '\0') {
+        fprintf(stderr, "Invalid y coordinate '%s'.\n", argv[2]);
+        return 1;
+    }
+    double delay = strtod(argv[3], &end);
+    if (*end != '\0' || delay < 0.0) {
+        fprintf(stderr, "Invalid delay '%s'.\n", argv[3]);
+        return 1;
+    }
+
+    client_wait_until(client_now_ns() + (uint64_t)(delay * (double)NSEC_PER_SEC));
+    return client_send(client, argv[0], -1, (int)x, (int)y) == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    const char* environment_path = "environment.txt";
+    const char* queue_override = NULL;
+    const char* file_path = NULL;
+    const char* mix_spec = NULL;
+    const char* spatial_spec = "uniform";
+    bool generate = false;
+    bool seeded = false;
+
+    client_t client;
+    memset(&client, 0, sizeof(client));
+
+    client_generator_t generator;
+    memset(&generator, 0, sizeof(generator));
+    generator.rate = CLIENT_DEFAULT_RATE;
+    generator.arrivals = CLIENT_ARRIVALS_POISSON;
+    generator.duration = CLIENT_DEFAULT_DURATION;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "f:gm:r:a:d:n:s:bS:q:e:h")) != -1) {
+        switch (opt) {
+            case 'f':
+                file_path = optarg;
+                break;
+            case 'g':
+                generate = true;
+                break;
+            case 'm':
+                mix_spec = optarg;
+                break;
+            case 'r':
+                generator.rate = strtod(optarg, NULL);
+                break;
+            case 'a':
+                if (strcmp(optarg, "poisson") == 0) {
+                    generator.arrivals = CLIENT_ARRIVALS_POISSON;
+                } else if (strcmp(optarg, "constant") == 0) {
+                    generator.arrivals = CLIENT_ARRIVALS_CONSTANT;
+                } else {
+                    fprintf(stderr, "Unknown arrival process '%s'.\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'd':
+                generator.duration = strtod(optarg, NULL);
+                break;
+            case 'n':
+                generator.count = strtoull(optarg, NULL, 10);
+                break;
+            case 's':
+                spatial_spec = optarg;
+                break;
+            case 'b':
+                client.binary = true;
+                break;
+            case 'S':
+                generator.rng = strtoull(optarg, NULL, 10);
+                seeded = true;
+                break;
+            case 'q':
+                queue_override = optarg;
+                break;
+            case 'e':
+                environment_path = optarg;
+                break;
+            case 'h':
+            default:
+                client_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    int positional = argc - optind;
+    if ((generate && (file_path || positional != 0)) || (file_path && positional != 0) ||
+        (!generate && !file_path && positional != 4)) {
+        client_usage(argv[0]);
+        return 1;
+    }
+
+    if (client.binary && !generate) {
+        fprintf(stderr, "-b is only supported by the generator.\n");
+        return 1;
+    }
+
+    // Environment parsing logs through the shared logger; keep it out of the
+    // server's application.log.
+    log_init("client.log");
+
+    environment_variable_t environment;
+    memset(&environment, 0, sizeof(environment));
+    if (parse_environment_variables(environment_path, &environment) != 0 && !queue_override) {
+        fprintf(stderr, "Failed to read '%s'; pass the queue with -q.\n", environment_path);
+        free(environment.queue);
+        log_shutdown();
+        return 1;
+    }
+
+    client.width = environment.width;
+    client.height = environment.height;
+    size_t shard_count = environment.mq_shards > 0 ? environment.mq_shards : 1;
+    if (shard_count > MQ_CONSUMER_MAX_SHARDS) {
+        shard_count = MQ_CONSUMER_MAX_SHARDS;
+    }
+
+    int result = 1;
+    if (generate) {
+        if (!mix_spec) {
+            fprintf(stderr, "The generator needs a type mix (-m).\n");
+            goto done;
+        }
+        if (generator.rate <= 0.0 || (generator.count == 0 && generator.duration <= 0.0)) {
+            fprintf(stderr, "Rate and duration must be positive.\n");
+            goto done;
+        }
+        if (client.width <= 0 || client.height <= 0) {
+            fprintf(stderr, "The generator needs the grid size from the environment file.\n");
+            goto done;
+        }
+        if (client_parse_mix(mix_spec, client.binary, &generator) != 0 ||
+            client_parse_spatial(spatial_spec, &generator) != 0) {
+            goto done;
+        }
+        if (!seeded) {
+            generator.rng = (uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32);
+        }
+        if (generator.rng == 0) {
+            generator.rng = 0x9E3779B97F4A7C15ULL;
+        }
+    }
+
+    if (client_open(&client, queue_override ? queue_override : environment.queue, shard_count) != 0) {
+        goto done;
+    }
+
+    if (generate) {
+        result = client_run_generator(&client, &generator);
+    } else if (file_path) {
+        result = client_run_file(&client, file_path);
+    } else {
+        result = client_run_single(&client, argv + optind);
+    }
+
+done:
+    client_close(&client);
+    free(environment.queue);
+    log_shutdown();
+    return result;
+}
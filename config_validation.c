@@ -3,6 +3,7 @@
 #include <stdio.h>
 
 #include "logging.h"
+#include "mq_consumer.h"
 
 static int validate_queue(const environment_variable_t* env) {
     if (!env->queue || env->queue[0] == '\0') {
@@ -47,6 +48,71 @@ static int validate_environment_timeouts(const environment_variable_t* env) {
     return 0;
 }
 
+static int validate_message_queue_settings(const environment_variable_t* env) {
+    if (env->mq_batch_size == 0 || env->mq_batch_size > MQ_CONSUMER_MAX_BATCH) {
+        fprintf(stderr, "Message queue batch size must be between 1 and %d.\n", MQ_CONSUMER_MAX_BATCH);
+        LOG_CONFIGURATION("CFG-MQ-BATCH-INVALID",
+                          "Message queue batch size %u outside [1,%d]",
+                          env->mq_batch_size,
+                          MQ_CONSUMER_MAX_BATCH);
+        return -1;
+    }
+
+    if (env->mq_shards == 0 || env->mq_shards > MQ_CONSUMER_MAX_SHARDS) {
+        fprintf(stderr, "Message queue shard count must be between 1 and %d.\n", MQ_CONSUMER_MAX_SHARDS);
+        LOG_CONFIGURATION("CFG-MQ-SHARDS-INVALID",
+                          "Message queue shard count %u outside [1,%d]",
+                          env->mq_shards,
+                          MQ_CONSUMER_MAX_SHARDS);
+        return -1;
+    }
+
+    if (env->mq_message_size != 0 && env->mq_message_size < MQ_CONSUMER_MIN_MSGSIZE) {
+        fprintf(stderr, "Message queue message size must be 0 (default) or at least %d.\n", MQ_CONSUMER_MIN_MSGSIZE);
+        LOG_CONFIGURATION("CFG-MQ-MSGSIZE-INVALID",
+                          "Message queue message size %u below minimum %d",
+                          env->mq_message_size,
+                          MQ_CONSUMER_MIN_MSGSIZE);
+        return -1;
+    }
+
+    if (env->batch_window_ms > RUNTIME_MAX_BATCH_WINDOW_MS) {
+        fprintf(stderr, "Batch window must be between 0 (off) and %d ms.\n", RUNTIME_MAX_BATCH_WINDOW_MS);
+        LOG_CONFIGURATION("CFG-BATCH-WINDOW-INVALID",
+                          "Batch window %u ms outside [0,%d]",
+                          env->batch_window_ms,
+                          RUNTIME_MAX_BATCH_WINDOW_MS);
+        return -1;
+    }
+
+    return 0;
+}
+
+// 0 picks the default for either limit; a configured minimum cannot exceed
+// a configured maximum.
+static int validate_worker_limits(const environment_variable_t* env) {
+    if (env->min_workers > RUNTIME_MAX_WORKERS || env->max_workers > RUNTIME_MAX_WORKERS) {
+        fprintf(stderr, "Worker limits must be between 0 (default) and %d.\n", RUNTIME_MAX_WORKERS);
+        LOG_CONFIGURATION("CFG-WORKERS-INVALID",
+                          "Worker limits min=%u max=%u outside [0,%d]",
+                          env->min_workers,
+                          env->max_workers,
+                          RUNTIME_MAX_WORKERS);
+        return -1;
+    }
+
+    if (env->min_workers != 0 && env->max_workers != 0 && env->min_workers > env->max_workers) {
+        fprintf(stderr, "min_workers cannot exceed max_workers.\n");
+        LOG_CONFIGURATION("CFG-WORKERS-INVALID",
+                          "min_workers=%u exceeds max_workers=%u",
+                          env->min_workers,
+                          env->max_workers);
+        return -1;
+    }
+
+    return 0;
+}
+
 static int validate_rescuer_positions(const app_context_t* ctx) {
     for (size_t i = 0; i < ctx->rescuer_type_count; ++i) {
         const rescuer_type_t* type = &ctx->rescuer_types[i];
@@ -93,6 +159,14 @@ int validate_configuration(const app_context_t* ctx) {
         return -1;
     }
 
+    if (validate_message_queue_settings(&ctx->environment) != 0) {
+        return -1;
+    }
+
+    if (validate_worker_limits(&ctx->environment) != 0) {
+        return -1;
+    }
+
     if (validate_rescuer_positions(ctx) != 0) {
         return -1;
     }
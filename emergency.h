@@ -19,6 +19,7 @@ typedef enum {
 
 typedef struct {
     char emergency_name[EMERGENCY_NAME_LENGTH];
+    int type_id; // index into the emergency type table, -1 to look up by name
     int x;
     int y;
     time_t timestamp;
@@ -14,9 +14,11 @@
 static FILE* g_log_file = NULL;
 static pthread_mutex_t g_log_mutex = PTHREAD_MUTEX_INITIALIZER;
 static char g_log_path[FILENAME_MAX] = LOG_DEFAULT_PATH;
+static time_t (*g_log_time_source)(const void* context) = NULL;
+static const void* g_log_time_context = NULL;
 
 static void log_get_timestamp(char* buffer, size_t size) {
-    time_t now = time(NULL);
+    time_t now = g_log_time_source ? g_log_time_source(g_log_time_context) : time(NULL);
     struct tm tm_info;
 #if defined(_POSIX_THREAD_SAFE_FUNCTIONS) && !defined(_WIN32)
     localtime_r(&now, &tm_info);
@@ -94,6 +96,13 @@ void log_shutdown(void) {
     pthread_mutex_unlock(&g_log_mutex);
 }
 
+void log_set_time_source(time_t (*source)(const void* context), const void* context) {
+    pthread_mutex_lock(&g_log_mutex);
+    g_log_time_source = source;
+    g_log_time_context = context;
+    pthread_mutex_unlock(&g_log_mutex);
+}
+
 void log_event_v(log_category_t category, const char* id, const char* fmt, va_list args) {
     pthread_mutex_lock(&g_log_mutex);
 
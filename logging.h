@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdarg.h>
+#include <time.h>
 
 typedef enum log_category_t {
     LOG_CATEGORY_FILE_PARSING = 0,
@@ -14,6 +15,8 @@ typedef enum log_category_t {
 
 int log_init(const char* path);
 void log_shutdown(void);
+// Replaces time(NULL) as the source of log timestamps; NULL restores it.
+void log_set_time_source(time_t (*source)(const void* context), const void* context);
 void log_event(log_category_t category, const char* id, const char* fmt, ...);
 void log_event_v(log_category_t category, const char* id, const char* fmt, va_list args);
 
@@ -12,11 +12,19 @@
 #include "parse_rescuers.h"
 #include "parse_emergency_types.h"
 #include "config_validation.h"
+#include "src/runtime/clock.h"
 #include "src/runtime/context.h"
+#include "src/runtime/simulation.h"
 #include "src/runtime/state.h"
 #include "logging.h"
 #include "mq_consumer.h"
 
+// Virtual start time of a simulation (2024-01-01 00:00:00 UTC), fixed so
+// that replaying a scenario twice produces the same log.
+#ifndef SIMULATION_EPOCH
+#define SIMULATION_EPOCH 1704067200
+#endif
+
 static volatile sig_atomic_t g_shutdown_requested = 0;
 static volatile sig_atomic_t g_shutdown_signal = 0;
 
@@ -25,12 +33,43 @@ static void handle_shutdown_signal(int signo) {
     g_shutdown_requested = 1;
 }
 
-int main(void) {
+static time_t log_time_from_clock(const void* context) {
+    return runtime_clock_now((const runtime_clock_t*)context);
+}
+
+static void print_usage(const char* program) {
+    fprintf(stderr, "Usage: %s [-s <scenario>]\n", program);
+    fprintf(stderr, "  -s <scenario>  replay '<name> <x> <y> <delay>' lines on a virtual clock and exit\n");
+}
+
+int main(int argc, char** argv) {
+    const char* scenario_path = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:")) != -1) {
+        if (opt == 's') {
+            scenario_path = optarg;
+        } else {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (optind < argc) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
     app_context_t context;
     app_context_init(&context);
 
-    mq_consumer_t consumer;
-    mq_consumer_init(&consumer);
+    runtime_clock_t clock;
+    if (scenario_path) {
+        runtime_clock_init_virtual(&clock, (time_t)SIMULATION_EPOCH);
+    } else {
+        runtime_clock_init_real(&clock);
+    }
+
+    mq_consumer_group_t consumers;
+    mq_consumer_group_init(&consumers);
     bool consumer_started = false;
     runtime_state_t runtime_state;
     bool runtime_initialized = false;
@@ -78,18 +117,52 @@ int main(void) {
         goto cleanup;
     }
 
+    status = emergency_type_index_build(&context.emergency_index,
+                                        context.emergency_types,
+                                        context.emergency_type_count,
+                                        context.rescuer_types,
+                                        context.rescuer_type_count);
+    if (status != 0) {
+        fprintf(stderr, "Failed to index emergency types.\n");
+        LOG_SYSTEM("SYS-ERROR", "Emergency type indexing failed with status %d", status);
+        goto cleanup;
+    }
+
     LOG_SYSTEM("SYS-READY", "Configuration parsed and validated successfully");
 
     if (runtime_state_init(&runtime_state,
                            context.rescuer_twins,
                            context.rescuer_twin_count,
-                           &context.environment) != 0) {
+                           &context.environment,
+                           &context.emergency_index,
+                           &clock) != 0) {
         fprintf(stderr, "Failed to initialize runtime state.\n");
         LOG_SYSTEM("SYS-ERROR", "Runtime state initialization failed");
         status = -1;
         goto cleanup;
     }
     runtime_initialized = true;
+    // The runtime owns the fleet from here on.
+    context.rescuer_twins = NULL;
+    context.rescuer_twin_count = 0;
+
+    if (scenario_path) {
+        // Single-threaded replay: no workers, consumers or signal handling.
+        log_set_time_source(log_time_from_clock, &clock);
+        runtime_simulation_stats_t stats;
+        if (runtime_simulation_run(&runtime_state, &clock, &context.environment, scenario_path, &stats) != 0) {
+            fprintf(stderr, "Failed to run scenario '%s'.\n", scenario_path);
+            status = -1;
+            goto cleanup;
+        }
+        printf("Simulated %lld s in %.3f s: %zu emergencies injected, %zu rejected, mean response %.1f s\n",
+               (long long)(stats.virtual_end - stats.virtual_start),
+               stats.wall_seconds,
+               stats.injected,
+               stats.rejected,
+               stats.mean_response_seconds);
+        goto cleanup;
+    }
 
     if (runtime_state_start_workers(&runtime_state, 0) != 0) {
         fprintf(stderr, "Failed to start runtime workers.\n");
@@ -111,11 +184,10 @@ int main(void) {
         goto cleanup;
     }
 
-    if (mq_consumer_start(&consumer,
-                          &context.environment,
-                          &runtime_state,
-                          context.emergency_types,
-                          context.emergency_type_count) != 0) {
+    if (mq_consumer_group_start(&consumers,
+                                &context.environment,
+                                &runtime_state,
+                                &context.emergency_index) != 0) {
         LOG_SYSTEM("SYS-ERROR", "Unable to start message queue consumer");
         status = -1;
         goto cleanup;
@@ -134,7 +206,7 @@ int main(void) {
 
 cleanup:
     if (consumer_started) {
-        mq_consumer_shutdown(&consumer);
+        mq_consumer_group_shutdown(&consumers);
         consumer_started = false;
     }
 
@@ -155,6 +227,7 @@ cleanup:
         LOG_SYSTEM("SYS-SHUTDOWN", "Graceful shutdown");
     }
 
+    log_set_time_source(NULL, NULL);
     app_context_cleanup(&context);
     log_shutdown();
     return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
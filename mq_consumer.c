@@ -1,121 +1,181 @@
 #define _POSIX_C_SOURCE 200809L
 #include "mq_consumer.h"
 
-#include <ctype.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
 #include <time.h>
 #include <unistd.h>
 
 #include "logging.h"
+#include "mq_message.h"
 
-static char* trim_whitespace(char* str) {
-    if (!str) {
-        return str;
+static void mq_consumer_log_request(const mq_consumer_t* consumer, const emergency_request_t* request) {
+    const char* name = request->emergency_name;
+    const emergency_type_descriptor_t* descriptor = emergency_type_index_get(consumer->type_index, request->type_id);
+    if (descriptor) {
+        name = descriptor->type->emergency_name;
     }
 
-    while (*str && isspace((unsigned char)*str)) {
-        ++str;
-    }
+    LOG_MESSAGE_QUEUE(
+        "MQ-EMERGENCY",
+        "Emergency '%s' received at (%d,%d) timestamp=%ld",
+        name,
+        request->x,
+        request->y,
+        (long)request->timestamp);
+}
 
-    if (*str == '\0') {
-        return str;
+static void mq_consumer_flush_batch(mq_consumer_t* consumer,
+                                    const emergency_request_t* requests,
+                                    size_t count) {
+    if (!consumer->runtime_state || count == 0) {
+        return;
     }
 
-    char* end = str + strlen(str) - 1;
-    while (end > str && isspace((unsigned char)*end)) {
-        *end-- = '\0';
+    int enqueued = runtime_state_dispatch_batch(consumer->runtime_state, requests, count);
+    if (enqueued < 0) {
+        LOG_EMERGENCY_STATUS("RT-DISPATCH-FAIL", "Failed to enqueue batch of %zu emergencies", count);
+        return;
     }
 
-    return str;
+    consumer->stats.dispatched += (unsigned long long)enqueued;
 }
 
-static bool mq_consumer_parse_message(mq_consumer_t* consumer, const char* message, emergency_request_t* out_request) {
-    if (!consumer || !message || !out_request) {
-        return false;
+int mq_consumer_watch_fd(mq_consumer_t* consumer, int fd, mq_consumer_fd_handler_t handler, void* arg) {
+    if (!consumer || fd < 0 || !handler || consumer->epoll_fd < 0) {
+        return -1;
     }
-
-    char buffer[MQ_CONSUMER_DEFAULT_MSGSIZE + 1];
-    size_t copy_len = strlen(message);
-    if (copy_len >= sizeof(buffer)) {
-        LOG_MESSAGE_QUEUE("MQ-INVALID", "Received message too large (%zu bytes)", copy_len);
-        return false;
+    if (consumer->watch_count >= MQ_CONSUMER_MAX_WATCHES) {
+        LOG_MESSAGE_QUEUE("MQ-EPOLL-ERR",
+                          "Failed to watch fd %d: the loop already watches %d descriptors",
+                          fd,
+                          MQ_CONSUMER_MAX_WATCHES);
+        return -1;
     }
 
-    memcpy(buffer, message, copy_len + 1);
+    // The entry is filled before epoll can report the fd.
+    mq_consumer_watch_t* watch = &consumer->watches[consumer->watch_count];
+    watch->fd = fd;
+    watch->handler = handler;
+    watch->arg = arg;
 
-    char* saveptr = NULL;
-    char* raw_name = strtok_r(buffer, ";", &saveptr);
-    char* raw_x = strtok_r(NULL, ";", &saveptr);
-    char* raw_y = strtok_r(NULL, ";", &saveptr);
-    char* raw_ts = strtok_r(NULL, ";", &saveptr);
-    char* extra = strtok_r(NULL, ";", &saveptr);
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = watch;
 
-    if (!raw_name || !raw_x || !raw_y || !raw_ts || extra) {
-        LOG_MESSAGE_QUEUE("MQ-INVALID", "Invalid message format: '%s'", message);
-        return false;
+    if (epoll_ctl(consumer->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        LOG_MESSAGE_QUEUE("MQ-EPOLL-ERR", "Failed to watch fd %d: %s", fd, strerror(errno));
+        return -1;
     }
 
-    char* name = trim_whitespace(raw_name);
-    char* x_str = trim_whitespace(raw_x);
-    char* y_str = trim_whitespace(raw_y);
-    char* ts_str = trim_whitespace(raw_ts);
+    ++consumer->watch_count;
+    return 0;
+}
 
-    size_t name_len = strlen(name);
-    if (name_len == 0 || name_len >= EMERGENCY_NAME_LENGTH) {
-        LOG_MESSAGE_QUEUE("MQ-INVALID", "Invalid emergency name '%s'", name);
-        return false;
-    }
+static void mq_consumer_drain_queue(mq_consumer_t* consumer,
+                                    mqd_t queue,
+                                    char* buffer,
+                                    emergency_request_t* batch) {
+    size_t batch_count = 0;
+    size_t received_count = 0;
+
+    // The clock is sampled once per batch instead of once per message.
+    const mq_parse_limits_t limits = {
+        .grid_width = consumer->grid_width,
+        .grid_height = consumer->grid_height,
+        .now = runtime_state_now(consumer->runtime_state),
+        .type_count = consumer->type_index->count,
+    };
 
-    char* endptr = NULL;
-    errno = 0;
-    long x_val = strtol(x_str, &endptr, 10);
-    if (errno != 0 || !endptr || *endptr != '\0') {
-        LOG_MESSAGE_QUEUE("MQ-INVALID", "Invalid X coordinate '%s'", x_str);
-        return false;
-    }
+    // The queue is opened with O_NONBLOCK, so a ready descriptor is drained
+    // until EAGAIN or a full batch. Level-triggered epoll reports it again if
+    // messages are left over, which keeps the stop event from starving.
+    while (received_count < consumer->batch_size) {
+        ssize_t received = mq_receive(queue, buffer, consumer->message_size, NULL);
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN) {
+                LOG_MESSAGE_QUEUE("MQ-RECEIVE-ERR", "mq_receive failed: %s", strerror(errno));
+            }
+            break;
+        }
 
-    errno = 0;
-    long y_val = strtol(y_str, &endptr, 10);
-    if (errno != 0 || !endptr || *endptr != '\0') {
-        LOG_MESSAGE_QUEUE("MQ-INVALID", "Invalid Y coordinate '%s'", y_str);
-        return false;
-    }
+        ++received_count;
 
-    errno = 0;
-    long long ts_val = strtoll(ts_str, &endptr, 10);
-    if (errno != 0 || !endptr || *endptr != '\0') {
-        LOG_MESSAGE_QUEUE("MQ-INVALID", "Invalid timestamp '%s'", ts_str);
-        return false;
+        emergency_request_t* request = &batch[batch_count];
+        mq_parse_status_t status = mq_message_decode(buffer, (size_t)received, &limits, request);
+        if (status == MQ_PARSE_OK && request->type_id < 0) {
+            // Resolve text names here, outside the runtime lock.
+            request->type_id = emergency_type_index_lookup(consumer->type_index, request->emergency_name);
+            if (request->type_id < 0) {
+                status = MQ_PARSE_UNKNOWN_TYPE;
+            }
+        }
+        if (status == MQ_PARSE_OK) {
+            mq_consumer_log_request(consumer, request);
+            ++batch_count;
+        } else if ((unsigned char)buffer[0] == MQ_MESSAGE_BINARY_MAGIC) {
+            LOG_MESSAGE_QUEUE("MQ-INVALID",
+                              "Rejected binary message (%s, %zd bytes)",
+                              mq_parse_status_to_string(status),
+                              received);
+            consumer->stats.invalid++;
+        } else {
+            buffer[received] = '\0';
+            LOG_MESSAGE_QUEUE("MQ-INVALID",
+                              "Rejected message (%s): '%s'",
+                              mq_parse_status_to_string(status),
+                              buffer);
+            consumer->stats.invalid++;
+        }
     }
 
-    if (x_val < 0 || (consumer->grid_width > 0 && x_val >= consumer->grid_width)) {
-        LOG_MESSAGE_QUEUE("MQ-INVALID", "X coordinate out of bounds: %ld", x_val);
-        return false;
-    }
+    consumer->stats.received += received_count;
 
-    if (y_val < 0 || (consumer->grid_height > 0 && y_val >= consumer->grid_height)) {
-        LOG_MESSAGE_QUEUE("MQ-INVALID", "Y coordinate out of bounds: %ld", y_val);
-        return false;
-    }
+    mq_consumer_flush_batch(consumer, batch, batch_count);
+}
 
-    time_t now = time(NULL);
-    if (ts_val <= 0 || (now != (time_t)-1 && ts_val > (long long)(now + 60))) {
-        LOG_MESSAGE_QUEUE("MQ-INVALID", "Timestamp not acceptable: %lld", ts_val);
-        return false;
+static void mq_consumer_on_stop(mq_consumer_t* consumer, int fd, void* arg) {
+    (void)arg;
+    uint64_t value;
+    while (read(fd, &value, sizeof(value)) < 0 && errno == EINTR) {
     }
+    consumer->running = false;
+}
 
-    memset(out_request, 0, sizeof(*out_request));
-    strncpy(out_request->emergency_name, name, sizeof(out_request->emergency_name) - 1);
-    out_request->x = (int)x_val;
-    out_request->y = (int)y_val;
-    out_request->timestamp = (time_t)ts_val;
+static void mq_consumer_on_queue(mq_consumer_t* consumer, int fd, void* arg) {
+    (void)fd;
+    (void)arg;
+    mq_consumer_drain_queue(consumer, consumer->queue, consumer->buffer, consumer->batch);
+}
 
-    return true;
+static void mq_consumer_log_stats(const mq_consumer_t* consumer) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double elapsed = (double)(now.tv_sec - consumer->stats.started_at.tv_sec) +
+                     (double)(now.tv_nsec - consumer->stats.started_at.tv_nsec) / 1e9;
+    double rate = elapsed > 0.0 ? (double)consumer->stats.received / elapsed : 0.0;
+
+    LOG_MESSAGE_QUEUE("MQ-SHARD-STATS",
+                      "Shard %zu '%s': received=%llu invalid=%llu dispatched=%llu in %.1fs (%.1f msg/s)",
+                      consumer->shard_index,
+                      consumer->queue_name,
+                      consumer->stats.received,
+                      consumer->stats.invalid,
+                      consumer->stats.dispatched,
+                      elapsed,
+                      rate);
 }
 
 static void* mq_consumer_thread(void* arg) {
@@ -124,62 +184,73 @@ static void* mq_consumer_thread(void* arg) {
         return NULL;
     }
 
-    LOG_MESSAGE_QUEUE("MQ-THREAD-START", "Consumer thread started for queue '%s'", consumer->queue_name);
-
-    char* buffer = calloc(consumer->message_size + 1, sizeof(char));
-    if (!buffer) {
-        LOG_MESSAGE_QUEUE("MQ-THREAD-ERROR", "Failed to allocate message buffer");
+    LOG_MESSAGE_QUEUE("MQ-THREAD-START",
+                      "Consumer thread started for queue '%s' (batch=%zu)",
+                      consumer->queue_name,
+                      consumer->batch_size);
+
+    consumer->buffer = calloc(consumer->message_size + 1, sizeof(char));
+    consumer->batch = calloc(consumer->batch_size, sizeof(emergency_request_t));
+    if (!consumer->buffer || !consumer->batch) {
+        LOG_MESSAGE_QUEUE("MQ-THREAD-ERROR", "Failed to allocate message buffers");
+        free(consumer->buffer);
+        free(consumer->batch);
+        consumer->buffer = NULL;
+        consumer->batch = NULL;
         return NULL;
     }
 
-    while (consumer->running) {
-        struct timespec abs_timeout;
-        clock_gettime(CLOCK_REALTIME, &abs_timeout);
-        abs_timeout.tv_sec += 1;
+    struct epoll_event events[MQ_CONSUMER_MAX_EVENTS];
+    clock_gettime(CLOCK_MONOTONIC, &consumer->stats.started_at);
 
-        ssize_t received = mq_timedreceive(consumer->queue, buffer, consumer->message_size, NULL, &abs_timeout);
-        if (received < 0) {
-            if (errno == ETIMEDOUT || errno == EAGAIN) {
-                continue;
-            }
+    while (consumer->running) {
+        int ready = epoll_wait(consumer->epoll_fd, events, MQ_CONSUMER_MAX_EVENTS, -1);
+        if (ready < 0) {
             if (errno == EINTR) {
                 continue;
             }
-
-            LOG_MESSAGE_QUEUE("MQ-RECEIVE-ERR", "mq_receive failed: %s", strerror(errno));
-            continue;
+            LOG_MESSAGE_QUEUE("MQ-EPOLL-ERR", "epoll_wait failed: %s", strerror(errno));
+            break;
         }
 
-        buffer[received] = '\0';
-
-        emergency_request_t request;
-        if (mq_consumer_parse_message(consumer, buffer, &request)) {
-            LOG_MESSAGE_QUEUE(
-                "MQ-EMERGENCY",
-                "Emergency '%s' received at (%d,%d) timestamp=%ld",
-                request.emergency_name,
-                request.x,
-                request.y,
-                (long)request.timestamp);
-
-            if (consumer->runtime_state) {
-                if (runtime_state_dispatch_request(consumer->runtime_state,
-                                                   &request,
-                                                   consumer->emergency_types,
-                                                   consumer->emergency_type_count) != 0) {
-                    LOG_EMERGENCY_STATUS("RT-DISPATCH-FAIL",
-                                         "Failed to enqueue emergency '%s'",
-                                         request.emergency_name);
-                }
-            }
+        for (int i = 0; i < ready && consumer->running; ++i) {
+            const mq_consumer_watch_t* watch = events[i].data.ptr;
+            watch->handler(consumer, watch->fd, watch->arg);
         }
     }
 
-    free(buffer);
+    free(consumer->batch);
+    free(consumer->buffer);
+    consumer->batch = NULL;
+    consumer->buffer = NULL;
+    // Records were allocated here; the runtime outlives this thread.
+    runtime_state_release_thread_cache(consumer->runtime_state);
+    mq_consumer_log_stats(consumer);
     LOG_MESSAGE_QUEUE("MQ-THREAD-STOP", "Consumer thread stopping for queue '%s'", consumer->queue_name);
     return NULL;
 }
 
+static void mq_consumer_close_fds(mq_consumer_t* consumer) {
+    if (consumer->epoll_fd >= 0) {
+        close(consumer->epoll_fd);
+        consumer->epoll_fd = -1;
+    }
+    consumer->watch_count = 0;
+
+    if (consumer->stop_fd >= 0) {
+        close(consumer->stop_fd);
+        consumer->stop_fd = -1;
+    }
+
+    if (consumer->queue != (mqd_t)-1) {
+        mq_close(consumer->queue);
+        if (consumer->queue_name[0] != '\0') {
+            mq_unlink(consumer->queue_name);
+        }
+        consumer->queue = (mqd_t)-1;
+    }
+}
+
 void mq_consumer_init(mq_consumer_t* consumer) {
     if (!consumer) {
         return;
@@ -187,26 +258,172 @@ void mq_consumer_init(mq_consumer_t* consumer) {
 
     memset(consumer, 0, sizeof(*consumer));
     consumer->queue = (mqd_t)-1;
+    consumer->epoll_fd = -1;
+    consumer->stop_fd = -1;
     consumer->message_size = MQ_CONSUMER_DEFAULT_MSGSIZE;
-    consumer->running = 0;
+    consumer->batch_size = MQ_CONSUMER_DEFAULT_BATCH;
+    consumer->running = false;
     consumer->grid_height = 0;
     consumer->grid_width = 0;
     consumer->thread_created = false;
-    consumer->emergency_types = NULL;
-    consumer->emergency_type_count = 0;
+    consumer->type_index = NULL;
     consumer->runtime_state = NULL;
 }
 
+static long mq_consumer_read_proc_limit(const char* path, long fallback) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return fallback;
+    }
+
+    long value = 0;
+    int matched = fscanf(file, "%ld", &value);
+    fclose(file);
+
+    return (matched == 1 && value > 0) ? value : fallback;
+}
+
+void mq_consumer_probe_limits(mq_consumer_limits_t* limits) {
+    if (!limits) {
+        return;
+    }
+
+    limits->msg_max = mq_consumer_read_proc_limit("/proc/sys/fs/mqueue/msg_max", MQ_CONSUMER_FALLBACK_MSG_MAX);
+    limits->msgsize_max =
+        mq_consumer_read_proc_limit("/proc/sys/fs/mqueue/msgsize_max", MQ_CONSUMER_FALLBACK_MSGSIZE_MAX);
+
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_MSGQUEUE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY) {
+        limits->rlimit = (unsigned long long)rl.rlim_cur;
+    } else {
+        limits->rlimit = 0;
+    }
+}
+
+void mq_consumer_choose_attributes(const environment_variable_t* environment,
+                                   const mq_consumer_limits_t* limits,
+                                   size_t shard_count,
+                                   struct mq_attr* out_attr) {
+    if (!environment || !limits || !out_attr) {
+        return;
+    }
+
+    long msgsize = environment->mq_message_size > 0 ? (long)environment->mq_message_size : MQ_CONSUMER_DEFAULT_MSGSIZE;
+    if (msgsize > limits->msgsize_max) {
+        msgsize = limits->msgsize_max;
+    }
+
+    long maxmsg = environment->mq_max_messages > 0 ? (long)environment->mq_max_messages : limits->msg_max;
+    if (maxmsg > limits->msg_max) {
+        maxmsg = limits->msg_max;
+    }
+
+    // The per-user byte budget is shared by every queue this process opens.
+    if (limits->rlimit > 0) {
+        size_t shards = shard_count > 0 ? shard_count : 1;
+        unsigned long long per_queue = limits->rlimit / shards;
+        unsigned long long per_message = (unsigned long long)msgsize + MQ_CONSUMER_MSG_OVERHEAD;
+        long affordable = (long)(per_queue / per_message);
+        if (affordable < maxmsg) {
+            maxmsg = affordable;
+        }
+    }
+
+    if (maxmsg < 1) {
+        maxmsg = 1;
+    }
+
+    memset(out_attr, 0, sizeof(*out_attr));
+    out_attr->mq_maxmsg = maxmsg;
+    out_attr->mq_msgsize = msgsize;
+}
+
+// Opens the shard's queue, reusing one left behind by an earlier run (or
+// created by producers) when its message size can hold every message format.
+// An incompatible queue is unlinked and created again with the chosen attributes.
+static mqd_t mq_consumer_open_queue(const mq_consumer_t* consumer, struct mq_attr* attr) {
+    const int flags = O_RDONLY | O_NONBLOCK;
+    mqd_t queue = mq_open(consumer->queue_name, flags | O_CREAT | O_EXCL, 0660, attr);
+    if (queue != (mqd_t)-1 || errno != EEXIST) {
+        return queue;
+    }
+
+    queue = mq_open(consumer->queue_name, flags);
+    if (queue == (mqd_t)-1) {
+        return queue;
+    }
+
+    struct mq_attr existing;
+    if (mq_getattr(queue, &existing) == 0 && existing.mq_msgsize >= MQ_CONSUMER_MIN_MSGSIZE) {
+        if (existing.mq_maxmsg < attr->mq_maxmsg) {
+            LOG_MESSAGE_QUEUE("MQ-REUSE-SHALLOW",
+                              "Existing queue '%s' holds %ld messages, fewer than the %ld chosen",
+                              consumer->queue_name,
+                              (long)existing.mq_maxmsg,
+                              (long)attr->mq_maxmsg);
+        }
+        LOG_MESSAGE_QUEUE("MQ-REUSE",
+                          "Reusing existing queue '%s' (msg_size=%ld max_msg=%ld pending=%ld)",
+                          consumer->queue_name,
+                          (long)existing.mq_msgsize,
+                          (long)existing.mq_maxmsg,
+                          (long)existing.mq_curmsgs);
+        *attr = existing;
+        return queue;
+    }
+
+    LOG_MESSAGE_QUEUE("MQ-RECREATE",
+                      "Existing queue '%s' has message size %ld below %d, recreating it",
+                      consumer->queue_name,
+                      (long)existing.mq_msgsize,
+                      MQ_CONSUMER_MIN_MSGSIZE);
+    mq_close(queue);
+    mq_unlink(consumer->queue_name);
+    return mq_open(consumer->queue_name, flags | O_CREAT | O_EXCL, 0660, attr);
+}
+
+static int mq_consumer_build_queue_name(mq_consumer_t* consumer,
+                                        const char* base_name,
+                                        size_t shard_index,
+                                        size_t shard_count) {
+    const char* slash = base_name[0] == '/' ? "" : "/";
+    int written;
+    if (shard_count > 1) {
+        written = snprintf(consumer->queue_name, sizeof(consumer->queue_name), "%s%s.%zu", slash, base_name, shard_index);
+    } else {
+        written = snprintf(consumer->queue_name, sizeof(consumer->queue_name), "%s%s", slash, base_name);
+    }
+
+    if (written < 0 || (size_t)written >= sizeof(consumer->queue_name)) {
+        consumer->queue_name[0] = '\0';
+        return -1;
+    }
+
+    return 0;
+}
+
 int mq_consumer_start(mq_consumer_t* consumer,
                       const environment_variable_t* environment,
                       runtime_state_t* runtime_state,
-                      const emergency_type_t* emergency_types,
-                      size_t emergency_type_count) {
+                      const emergency_type_index_t* type_index) {
+    return mq_consumer_start_shard(consumer, environment, 0, 1, runtime_state, type_index);
+}
+
+int mq_consumer_start_shard(mq_consumer_t* consumer,
+                            const environment_variable_t* environment,
+                            size_t shard_index,
+                            size_t shard_count,
+                            runtime_state_t* runtime_state,
+                            const emergency_type_index_t* type_index) {
     if (!consumer || !environment || !environment->queue) {
         return -1;
     }
 
-    if (!emergency_types || emergency_type_count == 0) {
+    if (shard_count == 0 || shard_index >= shard_count) {
+        return -1;
+    }
+
+    if (!type_index || type_index->count == 0) {
         return -1;
     }
 
@@ -218,55 +435,73 @@ int mq_consumer_start(mq_consumer_t* consumer,
 
     consumer->grid_width = environment->width;
     consumer->grid_height = environment->height;
-    consumer->emergency_types = emergency_types;
-    consumer->emergency_type_count = emergency_type_count;
+    consumer->type_index = type_index;
     consumer->runtime_state = runtime_state;
+    consumer->shard_index = shard_index;
+    if (environment->mq_batch_size > 0) {
+        consumer->batch_size = environment->mq_batch_size;
+    }
 
-    const char* queue_name = environment->queue;
-    if (queue_name[0] == '/') {
-        if (strlen(queue_name) >= sizeof(consumer->queue_name)) {
-            LOG_MESSAGE_QUEUE("MQ-INIT-ERR", "Queue name '%s' is too long", queue_name);
-            return -1;
+    if (mq_consumer_build_queue_name(consumer, environment->queue, shard_index, shard_count) != 0) {
+        LOG_MESSAGE_QUEUE("MQ-INIT-ERR", "Queue name '%s' is too long", environment->queue);
+        return -1;
+    }
+
+    mq_consumer_limits_t limits;
+    mq_consumer_probe_limits(&limits);
+
+    struct mq_attr attr;
+    mq_consumer_choose_attributes(environment, &limits, shard_count, &attr);
+
+    if (shard_index == 0) {
+        LOG_MESSAGE_QUEUE("MQ-LIMITS",
+                          "System limits msg_max=%ld msgsize_max=%ld rlimit=%llu; chose max_msg=%ld msg_size=%ld per queue",
+                          limits.msg_max,
+                          limits.msgsize_max,
+                          limits.rlimit,
+                          (long)attr.mq_maxmsg,
+                          (long)attr.mq_msgsize);
+        if (environment->mq_max_messages > (unsigned int)attr.mq_maxmsg) {
+            LOG_MESSAGE_QUEUE("MQ-LIMITS-CLAMP",
+                              "Requested mq_max_messages=%u clamped to %ld",
+                              environment->mq_max_messages,
+                              (long)attr.mq_maxmsg);
         }
-        strncpy(consumer->queue_name, queue_name, sizeof(consumer->queue_name) - 1);
-        consumer->queue_name[sizeof(consumer->queue_name) - 1] = '\0';
-        consumer->queue_name[strlen(consumer->queue_name)] = '\0';
-    } else {
-        size_t needed = strlen(queue_name) + 1; // plus slash
-        if (needed >= sizeof(consumer->queue_name)) {
-            LOG_MESSAGE_QUEUE("MQ-INIT-ERR", "Queue name '%s' is too long", queue_name);
-            return -1;
+        if (environment->mq_message_size > (unsigned int)attr.mq_msgsize) {
+            LOG_MESSAGE_QUEUE("MQ-LIMITS-CLAMP",
+                              "Requested mq_message_size=%u clamped to %ld",
+                              environment->mq_message_size,
+                              (long)attr.mq_msgsize);
         }
-        consumer->queue_name[0] = '/';
-        strncpy(consumer->queue_name + 1, queue_name, sizeof(consumer->queue_name) - 2);
-        consumer->queue_name[sizeof(consumer->queue_name) - 1] = '\0';
-        consumer->queue_name[needed] = '\0';
     }
 
-    struct mq_attr attr = {
-        .mq_flags = 0,
-        .mq_maxmsg = MQ_CONSUMER_DEFAULT_MAXMSG,
-        .mq_msgsize = MQ_CONSUMER_DEFAULT_MSGSIZE,
-        .mq_curmsgs = 0,
-    };
-
-    consumer->message_size = attr.mq_msgsize;
-
-    consumer->queue = mq_open(consumer->queue_name, O_RDONLY | O_CREAT, 0660, &attr);
+    consumer->queue = mq_consumer_open_queue(consumer, &attr);
     if (consumer->queue == (mqd_t)-1) {
         LOG_MESSAGE_QUEUE("MQ-INIT-ERR", "Failed to open queue '%s': %s", consumer->queue_name, strerror(errno));
         return -1;
     }
 
-    consumer->running = 1;
+    // mq_receive needs a buffer at least as large as the queue's message size,
+    // which for a reused queue may differ from the one chosen above.
+    consumer->message_size = (size_t)attr.mq_msgsize;
+
+    consumer->stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    consumer->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (consumer->stop_fd < 0 || consumer->epoll_fd < 0 ||
+        mq_consumer_watch_fd(consumer, consumer->stop_fd, mq_consumer_on_stop, NULL) != 0 ||
+        mq_consumer_watch_fd(consumer, (int)consumer->queue, mq_consumer_on_queue, NULL) != 0) {
+        LOG_MESSAGE_QUEUE("MQ-INIT-ERR", "Failed to set up event loop: %s", strerror(errno));
+        mq_consumer_close_fds(consumer);
+        return -1;
+    }
+
+    consumer->running = true;
 
     int rc = pthread_create(&consumer->thread, NULL, mq_consumer_thread, consumer);
     if (rc != 0) {
         LOG_MESSAGE_QUEUE("MQ-INIT-ERR", "Failed to create consumer thread: %s", strerror(rc));
-        consumer->running = 0;
-        mq_close(consumer->queue);
-        mq_unlink(consumer->queue_name);
-        consumer->queue = (mqd_t)-1;
+        consumer->running = false;
+        mq_consumer_close_fds(consumer);
         return -1;
     }
 
@@ -274,10 +509,13 @@ int mq_consumer_start(mq_consumer_t* consumer,
 
     LOG_MESSAGE_QUEUE(
         "MQ-INIT",
-        "Message queue '%s' initialized (msg_size=%ld max_msg=%ld)",
+        "Message queue '%s' initialized (shard=%zu/%zu msg_size=%ld max_msg=%ld batch=%zu)",
         consumer->queue_name,
+        shard_index,
+        shard_count,
         (long)attr.mq_msgsize,
-        (long)attr.mq_maxmsg);
+        (long)attr.mq_maxmsg,
+        consumer->batch_size);
 
     return 0;
 }
@@ -287,7 +525,13 @@ void mq_consumer_request_stop(mq_consumer_t* consumer) {
         return;
     }
 
-    consumer->running = 0;
+    // Only write(2) is used here so the function stays async-signal-safe;
+    // the consumer thread clears running itself when it reads the event.
+    if (consumer->stop_fd >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(consumer->stop_fd, &one, sizeof(one));
+        (void)written;
+    }
 }
 
 void mq_consumer_shutdown(mq_consumer_t* consumer) {
@@ -303,18 +547,83 @@ void mq_consumer_shutdown(mq_consumer_t* consumer) {
         consumer->thread_created = false;
     }
 
-    if (consumer->queue != (mqd_t)-1) {
-        mq_close(consumer->queue);
-        if (consumer->queue_name[0] != '\0') {
-            mq_unlink(consumer->queue_name);
-        }
-        consumer->queue = (mqd_t)-1;
-    }
+    mq_consumer_close_fds(consumer);
 
     consumer->message_size = MQ_CONSUMER_DEFAULT_MSGSIZE;
+    consumer->batch_size = MQ_CONSUMER_DEFAULT_BATCH;
     consumer->queue_name[0] = '\0';
-    consumer->emergency_types = NULL;
-    consumer->emergency_type_count = 0;
+    consumer->type_index = NULL;
     consumer->runtime_state = NULL;
 }
 
+void mq_consumer_group_init(mq_consumer_group_t* group) {
+    if (!group) {
+        return;
+    }
+
+    memset(group, 0, sizeof(*group));
+}
+
+int mq_consumer_group_start(mq_consumer_group_t* group,
+                            const environment_variable_t* environment,
+                            runtime_state_t* runtime_state,
+                            const emergency_type_index_t* type_index) {
+    if (!group || !environment) {
+        return -1;
+    }
+
+    size_t shard_count = environment->mq_shards > 0 ? environment->mq_shards : 1;
+    group->shards = calloc(shard_count, sizeof(mq_consumer_t));
+    if (!group->shards) {
+        LOG_MESSAGE_QUEUE("MQ-INIT-ERR", "Failed to allocate %zu consumer shards", shard_count);
+        return -1;
+    }
+
+    for (size_t i = 0; i < shard_count; ++i) {
+        mq_consumer_init(&group->shards[i]);
+        if (mq_consumer_start_shard(&group->shards[i],
+                                    environment,
+                                    i,
+                                    shard_count,
+                                    runtime_state,
+                                    type_index) != 0) {
+            mq_consumer_group_shutdown(group);
+            return -1;
+        }
+        group->shard_count = i + 1;
+    }
+
+    LOG_MESSAGE_QUEUE("MQ-INIT", "Started %zu consumer shard(s) for queue '%s'", shard_count, environment->queue);
+
+    // Binary messages carry the type as its position in emergency.txt.
+    for (size_t i = 0; i < type_index->count; ++i) {
+        LOG_MESSAGE_QUEUE("MQ-TYPE-ID", "Binary type ID %zu = '%s'", i, type_index->descriptors[i].type->emergency_name);
+    }
+    return 0;
+}
+
+void mq_consumer_group_request_stop(mq_consumer_group_t* group) {
+    if (!group || !group->shards) {
+        return;
+    }
+
+    for (size_t i = 0; i < group->shard_count; ++i) {
+        mq_consumer_request_stop(&group->shards[i]);
+    }
+}
+
+void mq_consumer_group_shutdown(mq_consumer_group_t* group) {
+    if (!group || !group->shards) {
+        return;
+    }
+
+    // Signal every shard first so they all stop in parallel before joining.
+    mq_consumer_group_request_stop(group);
+    for (size_t i = 0; i < group->shard_count; ++i) {
+        mq_consumer_shutdown(&group->shards[i]);
+    }
+
+    free(group->shards);
+    group->shards = NULL;
+    group->shard_count = 0;
+}
@@ -2,7 +2,6 @@
 
 #include <mqueue.h>
 #include <pthread.h>
-#include <signal.h>
 #include <stddef.h>
 #include <stdbool.h>
 #include <time.h>
@@ -11,39 +10,150 @@
 #include "emergency.h"
 #include "parse_env.h"
 #include "src/runtime/state.h"
+#include "src/runtime/type_index.h"
 
 #ifndef MQ_CONSUMER_MAX_QUEUE_NAME
 #define MQ_CONSUMER_MAX_QUEUE_NAME 255
 #endif
 
-#ifndef MQ_CONSUMER_DEFAULT_MAXMSG
-#define MQ_CONSUMER_DEFAULT_MAXMSG 32
-#endif
-
 #ifndef MQ_CONSUMER_DEFAULT_MSGSIZE
 #define MQ_CONSUMER_DEFAULT_MSGSIZE 256
 #endif
 
+// Smallest message size that still fits a maximal text message
+// (63-character name and three full-width integers).
+#ifndef MQ_CONSUMER_MIN_MSGSIZE
+#define MQ_CONSUMER_MIN_MSGSIZE 128
+#endif
+
+// Kernel bookkeeping charged per message against RLIMIT_MSGQUEUE, rounded up.
+#ifndef MQ_CONSUMER_MSG_OVERHEAD
+#define MQ_CONSUMER_MSG_OVERHEAD 64
+#endif
+
+// Linux defaults, used when /proc/sys/fs/mqueue cannot be read.
+#ifndef MQ_CONSUMER_FALLBACK_MSG_MAX
+#define MQ_CONSUMER_FALLBACK_MSG_MAX 10
+#endif
+
+#ifndef MQ_CONSUMER_FALLBACK_MSGSIZE_MAX
+#define MQ_CONSUMER_FALLBACK_MSGSIZE_MAX 8192
+#endif
+
+#ifndef MQ_CONSUMER_MAX_SHARDS
+#define MQ_CONSUMER_MAX_SHARDS 64
+#endif
+
+#ifndef MQ_CONSUMER_MAX_EVENTS
+#define MQ_CONSUMER_MAX_EVENTS 8
+#endif
+
+// Descriptors one consumer loop can watch, the stop event and the queue
+// included.
+#ifndef MQ_CONSUMER_MAX_WATCHES
+#define MQ_CONSUMER_MAX_WATCHES 8
+#endif
+
+#ifndef MQ_CONSUMER_DEFAULT_BATCH
+#define MQ_CONSUMER_DEFAULT_BATCH 16
+#endif
+
+// Largest mq_batch_size accepted; the consumer allocates that many requests.
+#ifndef MQ_CONSUMER_MAX_BATCH
+#define MQ_CONSUMER_MAX_BATCH 1024
+#endif
+
+typedef struct mq_consumer_limits_t {
+    long msg_max;                // /proc/sys/fs/mqueue/msg_max
+    long msgsize_max;            // /proc/sys/fs/mqueue/msgsize_max
+    unsigned long long rlimit;   // RLIMIT_MSGQUEUE in bytes, 0 if unlimited
+} mq_consumer_limits_t;
+
+typedef struct mq_consumer_stats_t {
+    unsigned long long received;
+    unsigned long long invalid;
+    unsigned long long dispatched;
+    struct timespec started_at;
+} mq_consumer_stats_t;
+
+struct mq_consumer_t;
+
+// Runs on the consumer thread when fd is readable. The loop is
+// level-triggered, so it must consume whatever made fd ready.
+typedef void (*mq_consumer_fd_handler_t)(struct mq_consumer_t* consumer, int fd, void* arg);
+
+typedef struct mq_consumer_watch_t {
+    int fd;
+    mq_consumer_fd_handler_t handler;
+    void* arg;
+} mq_consumer_watch_t;
+
 typedef struct mq_consumer_t {
     mqd_t queue;
+    int epoll_fd;
+    int stop_fd;
+    // Watched descriptors; each epoll event carries a pointer to its entry.
+    mq_consumer_watch_t watches[MQ_CONSUMER_MAX_WATCHES];
+    size_t watch_count;
+    char* buffer;                 // one message, owned by the consumer thread
+    emergency_request_t* batch;   // batch_size requests, likewise
     pthread_t thread;
     size_t message_size;
-    volatile sig_atomic_t running;
+    size_t batch_size;
+    bool running; // set before the thread starts, then only cleared by it
     char queue_name[MQ_CONSUMER_MAX_QUEUE_NAME + 1];
+    size_t shard_index;
+    mq_consumer_stats_t stats;
     int grid_width;
     int grid_height;
     bool thread_created;
-    const struct emergency_type_t* emergency_types;
-    size_t emergency_type_count;
+    const emergency_type_index_t* type_index;
     runtime_state_t* runtime_state;
 } mq_consumer_t;
 
+typedef struct mq_consumer_group_t {
+    mq_consumer_t* shards;
+    size_t shard_count;
+} mq_consumer_group_t;
+
 void mq_consumer_init(mq_consumer_t* consumer);
+
+// Reads the system message queue limits, falling back to the Linux defaults
+// for any value that cannot be read.
+void mq_consumer_probe_limits(mq_consumer_limits_t* limits);
+
+// Picks queue attributes for one of shard_count queues: the configured values
+// clamped to the limits, or the largest allowed depth when the environment
+// leaves mq_max_messages at 0. The RLIMIT_MSGQUEUE budget is split evenly
+// across the shards.
+void mq_consumer_choose_attributes(const environment_variable_t* environment,
+                                   const mq_consumer_limits_t* limits,
+                                   size_t shard_count,
+                                   struct mq_attr* out_attr);
 int mq_consumer_start(mq_consumer_t* consumer,
                       const environment_variable_t* environment,
                       runtime_state_t* runtime_state,
-                      const struct emergency_type_t* emergency_types,
-                      size_t emergency_type_count);
+                      const emergency_type_index_t* type_index);
+int mq_consumer_start_shard(mq_consumer_t* consumer,
+                            const environment_variable_t* environment,
+                            size_t shard_index,
+                            size_t shard_count,
+                            runtime_state_t* runtime_state,
+                            const emergency_type_index_t* type_index);
 void mq_consumer_request_stop(mq_consumer_t* consumer);
 void mq_consumer_shutdown(mq_consumer_t* consumer);
 
+// Adds fd to the consumer's event loop: handler runs on the consumer thread
+// each time fd is readable. Call it after mq_consumer_start() from the
+// thread that started the consumer, or from a handler. The caller keeps
+// ownership of fd and must not close it before mq_consumer_shutdown().
+// Returns -1 when the loop is full or epoll refuses fd.
+int mq_consumer_watch_fd(mq_consumer_t* consumer, int fd, mq_consumer_fd_handler_t handler, void* arg);
+
+void mq_consumer_group_init(mq_consumer_group_t* group);
+int mq_consumer_group_start(mq_consumer_group_t* group,
+                            const environment_variable_t* environment,
+                            runtime_state_t* runtime_state,
+                            const emergency_type_index_t* type_index);
+void mq_consumer_group_request_stop(mq_consumer_group_t* group);
+void mq_consumer_group_shutdown(mq_consumer_group_t* group);
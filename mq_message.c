@@ -0,0 +1,282 @@
+#include "mq_message.h"
+
+#include <limits.h>
+#include <stdbool.h>
+#include <string.h>
+
+// A NUL byte inside the received payload terminates the message, like the
+// old strtok-based parser did.
+static inline bool at_end(const char* p, const char* end) {
+    return p >= end || *p == '\0';
+}
+
+static inline bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline const char* skip_blanks(const char* p, const char* end) {
+    while (!at_end(p, end) && is_blank(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+// Parses one optionally signed decimal field, surrounding blanks allowed, and
+// leaves *cursor on the delimiter (or the end of the message). Returns false
+// for empty fields, stray characters and values that overflow long long.
+static bool parse_integer_field(const char** cursor, const char* end, long long* out_value) {
+    const char* p = skip_blanks(*cursor, end);
+
+    bool negative = false;
+    if (!at_end(p, end) && (*p == '+' || *p == '-')) {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    if (at_end(p, end) || *p < '0' || *p > '9') {
+        return false;
+    }
+
+    unsigned long long value = 0;
+    const unsigned long long limit = negative ? (unsigned long long)LLONG_MAX + 1ULL : (unsigned long long)LLONG_MAX;
+    while (!at_end(p, end) && *p >= '0' && *p <= '9') {
+        unsigned int digit = (unsigned int)(*p - '0');
+        if (value > (limit - digit) / 10ULL) {
+            return false;
+        }
+        value = value * 10ULL + digit;
+        ++p;
+    }
+
+    p = skip_blanks(p, end);
+    if (!at_end(p, end) && *p != ';') {
+        return false;
+    }
+
+    if (negative) {
+        *out_value = value == (unsigned long long)LLONG_MAX + 1ULL ? LLONG_MIN : -(long long)value;
+    } else {
+        *out_value = (long long)value;
+    }
+    *cursor = p;
+    return true;
+}
+
+// Consumes the ';' that must follow a non-final field.
+static inline bool expect_delimiter(const char** cursor, const char* end) {
+    if (at_end(*cursor, end)) {
+        return false;
+    }
+    ++*cursor;
+    return true;
+}
+
+static mq_parse_status_t validate_request_fields(long long x_val,
+                                                 long long y_val,
+                                                 long long ts_val,
+                                                 const mq_parse_limits_t* limits) {
+    int width = limits ? limits->grid_width : 0;
+    int height = limits ? limits->grid_height : 0;
+    time_t now = limits ? limits->now : (time_t)-1;
+
+    if (x_val < 0 || x_val > INT_MAX || (width > 0 && x_val >= width)) {
+        return MQ_PARSE_X_OUT_OF_BOUNDS;
+    }
+
+    if (y_val < 0 || y_val > INT_MAX || (height > 0 && y_val >= height)) {
+        return MQ_PARSE_Y_OUT_OF_BOUNDS;
+    }
+
+    if (ts_val <= 0 || (now != (time_t)-1 && ts_val > (long long)now + MQ_MESSAGE_MAX_CLOCK_SKEW)) {
+        return MQ_PARSE_TIMESTAMP_REJECTED;
+    }
+
+    return MQ_PARSE_OK;
+}
+
+static inline uint64_t read_le(const unsigned char* p, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= (uint64_t)p[i] << (8 * i);
+    }
+    return value;
+}
+
+static inline void write_le(unsigned char* p, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        p[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+mq_parse_status_t mq_message_parse(const char* message,
+                                   size_t length,
+                                   const mq_parse_limits_t* limits,
+                                   emergency_request_t* out_request) {
+    if (!message || !out_request) {
+        return MQ_PARSE_EMPTY;
+    }
+
+    const char* end = message + length;
+    const char* p = skip_blanks(message, end);
+    if (at_end(p, end)) {
+        return MQ_PARSE_EMPTY;
+    }
+
+    const char* name_begin = p;
+    while (!at_end(p, end) && *p != ';') {
+        ++p;
+    }
+    const char* name_end = p;
+    while (name_end > name_begin && is_blank(name_end[-1])) {
+        --name_end;
+    }
+
+    size_t name_len = (size_t)(name_end - name_begin);
+    if (name_len == 0 || name_len >= EMERGENCY_NAME_LENGTH) {
+        return MQ_PARSE_BAD_NAME;
+    }
+    if (!expect_delimiter(&p, end)) {
+        return MQ_PARSE_MISSING_FIELD;
+    }
+
+    long long x_val = 0;
+    if (at_end(p, end)) {
+        return MQ_PARSE_MISSING_FIELD;
+    }
+    if (!parse_integer_field(&p, end, &x_val)) {
+        return MQ_PARSE_BAD_X;
+    }
+    if (!expect_delimiter(&p, end)) {
+        return MQ_PARSE_MISSING_FIELD;
+    }
+
+    long long y_val = 0;
+    if (at_end(p, end)) {
+        return MQ_PARSE_MISSING_FIELD;
+    }
+    if (!parse_integer_field(&p, end, &y_val)) {
+        return MQ_PARSE_BAD_Y;
+    }
+    if (!expect_delimiter(&p, end)) {
+        return MQ_PARSE_MISSING_FIELD;
+    }
+
+    long long ts_val = 0;
+    if (at_end(p, end)) {
+        return MQ_PARSE_MISSING_FIELD;
+    }
+    if (!parse_integer_field(&p, end, &ts_val)) {
+        return MQ_PARSE_BAD_TIMESTAMP;
+    }
+    if (!at_end(p, end)) {
+        return MQ_PARSE_EXTRA_FIELD;
+    }
+
+    mq_parse_status_t status = validate_request_fields(x_val, y_val, ts_val, limits);
+    if (status != MQ_PARSE_OK) {
+        return status;
+    }
+
+    memcpy(out_request->emergency_name, name_begin, name_len);
+    out_request->emergency_name[name_len] = '\0';
+    out_request->type_id = -1;
+    out_request->x = (int)x_val;
+    out_request->y = (int)y_val;
+    out_request->timestamp = (time_t)ts_val;
+
+    return MQ_PARSE_OK;
+}
+
+mq_parse_status_t mq_message_parse_binary(const unsigned char* message,
+                                          size_t length,
+                                          const mq_parse_limits_t* limits,
+                                          emergency_request_t* out_request) {
+    if (!message || !out_request) {
+        return MQ_PARSE_EMPTY;
+    }
+
+    if (length != MQ_MESSAGE_BINARY_SIZE || message[0] != MQ_MESSAGE_BINARY_MAGIC || message[1] != 0) {
+        return MQ_PARSE_BAD_BINARY;
+    }
+
+    uint16_t type_id = (uint16_t)read_le(message + 2, 2);
+    int32_t x_val = (int32_t)(uint32_t)read_le(message + 4, 4);
+    int32_t y_val = (int32_t)(uint32_t)read_le(message + 8, 4);
+    int64_t ts_val = (int64_t)read_le(message + 12, 8);
+
+    if (!limits || (size_t)type_id >= limits->type_count) {
+        return MQ_PARSE_UNKNOWN_TYPE;
+    }
+
+    mq_parse_status_t status = validate_request_fields(x_val, y_val, ts_val, limits);
+    if (status != MQ_PARSE_OK) {
+        return status;
+    }
+
+    out_request->emergency_name[0] = '\0';
+    out_request->type_id = (int)type_id;
+    out_request->x = (int)x_val;
+    out_request->y = (int)y_val;
+    out_request->timestamp = (time_t)ts_val;
+
+    return MQ_PARSE_OK;
+}
+
+mq_parse_status_t mq_message_decode(const char* message,
+                                    size_t length,
+                                    const mq_parse_limits_t* limits,
+                                    emergency_request_t* out_request) {
+    if (message && length > 0 && (unsigned char)message[0] == MQ_MESSAGE_BINARY_MAGIC) {
+        return mq_message_parse_binary((const unsigned char*)message, length, limits, out_request);
+    }
+
+    return mq_message_parse(message, length, limits, out_request);
+}
+
+size_t mq_message_encode_binary(uint16_t type_id, int32_t x, int32_t y, int64_t timestamp, unsigned char* buffer) {
+    if (!buffer) {
+        return 0;
+    }
+
+    buffer[0] = MQ_MESSAGE_BINARY_MAGIC;
+    buffer[1] = 0;
+    write_le(buffer + 2, type_id, 2);
+    write_le(buffer + 4, (uint32_t)x, 4);
+    write_le(buffer + 8, (uint32_t)y, 4);
+    write_le(buffer + 12, (uint64_t)timestamp, 8);
+    return MQ_MESSAGE_BINARY_SIZE;
+}
+
+const char* mq_parse_status_to_string(mq_parse_status_t status) {
+    switch (status) {
+        case MQ_PARSE_OK:
+            return "OK";
+        case MQ_PARSE_EMPTY:
+            return "EMPTY";
+        case MQ_PARSE_MISSING_FIELD:
+            return "MISSING_FIELD";
+        case MQ_PARSE_EXTRA_FIELD:
+            return "EXTRA_FIELD";
+        case MQ_PARSE_BAD_NAME:
+            return "BAD_NAME";
+        case MQ_PARSE_BAD_X:
+            return "BAD_X";
+        case MQ_PARSE_BAD_Y:
+            return "BAD_Y";
+        case MQ_PARSE_BAD_TIMESTAMP:
+            return "BAD_TIMESTAMP";
+        case MQ_PARSE_X_OUT_OF_BOUNDS:
+            return "X_OUT_OF_BOUNDS";
+        case MQ_PARSE_Y_OUT_OF_BOUNDS:
+            return "Y_OUT_OF_BOUNDS";
+        case MQ_PARSE_TIMESTAMP_REJECTED:
+            return "TIMESTAMP_REJECTED";
+        case MQ_PARSE_BAD_BINARY:
+            return "BAD_BINARY";
+        case MQ_PARSE_UNKNOWN_TYPE:
+            return "UNKNOWN_TYPE";
+        case MQ_PARSE_STATUS_COUNT:
+        default:
+            return "UNKNOWN";
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "emergency.h"
+
+// Messages may carry a timestamp at most this far in the future.
+#define MQ_MESSAGE_MAX_CLOCK_SKEW 60
+
+// Binary layout, all integers little-endian:
+//   [0]      magic (high nibble) and version (low nibble)
+//   [1]      reserved, must be zero
+//   [2..3]   uint16 emergency type ID (order of entries in emergency.txt)
+//   [4..7]   int32 x
+//   [8..11]  int32 y
+//   [12..19] int64 timestamp
+// The magic byte has its high bit set, so it never starts a text message.
+#define MQ_MESSAGE_BINARY_MAGIC 0xB1
+#define MQ_MESSAGE_BINARY_SIZE 20
+
+typedef enum mq_parse_status_t {
+    MQ_PARSE_OK = 0,
+    MQ_PARSE_EMPTY,
+    MQ_PARSE_MISSING_FIELD,
+    MQ_PARSE_EXTRA_FIELD,
+    MQ_PARSE_BAD_NAME,
+    MQ_PARSE_BAD_X,
+    MQ_PARSE_BAD_Y,
+    MQ_PARSE_BAD_TIMESTAMP,
+    MQ_PARSE_X_OUT_OF_BOUNDS,
+    MQ_PARSE_Y_OUT_OF_BOUNDS,
+    MQ_PARSE_TIMESTAMP_REJECTED,
+    MQ_PARSE_BAD_BINARY,
+    MQ_PARSE_UNKNOWN_TYPE,
+    MQ_PARSE_STATUS_COUNT
+} mq_parse_status_t;
+
+typedef struct mq_parse_limits_t {
+    int grid_width;  // <= 0 disables the check
+    int grid_height; // <= 0 disables the check
+    time_t now;      // (time_t)-1 disables the future-timestamp check
+    size_t type_count; // number of valid binary type IDs
+} mq_parse_limits_t;
+
+// Parses a "name;x;y;timestamp" message of the given length in a single pass.
+// The input is not modified and does not need to be NUL-terminated; on
+// MQ_PARSE_OK the request is filled in, otherwise it is left untouched.
+mq_parse_status_t mq_message_parse(const char* message,
+                                   size_t length,
+                                   const mq_parse_limits_t* limits,
+                                   emergency_request_t* out_request);
+
+// Decodes a fixed-size binary message. The type ID is checked against
+// limits->type_count and stored in out_request->type_id; the name is left
+// empty because the runtime resolves it from the ID.
+mq_parse_status_t mq_message_parse_binary(const unsigned char* message,
+                                          size_t length,
+                                          const mq_parse_limits_t* limits,
+                                          emergency_request_t* out_request);
+
+// Accepts either format, telling them apart by the first byte.
+mq_parse_status_t mq_message_decode(const char* message,
+                                    size_t length,
+                                    const mq_parse_limits_t* limits,
+                                    emergency_request_t* out_request);
+
+// Writes a binary message into buffer (at least MQ_MESSAGE_BINARY_SIZE bytes)
+// and returns the number of bytes to send.
+size_t mq_message_encode_binary(uint16_t type_id, int32_t x, int32_t y, int64_t timestamp, unsigned char* buffer);
+
+const char* mq_parse_status_to_string(mq_parse_status_t status);
@@ -12,6 +12,13 @@
 #define DEFAULT_PRIORITY_TIMEOUT_HIGH 60
 #define DEFAULT_AGING_START 90
 #define DEFAULT_AGING_STEP 30
+#define DEFAULT_MQ_BATCH_SIZE 16
+#define DEFAULT_MQ_SHARDS 1
+#define DEFAULT_MQ_MAX_MESSAGES 0
+#define DEFAULT_MQ_MESSAGE_SIZE 0
+#define DEFAULT_BATCH_WINDOW_MS 0
+#define DEFAULT_MIN_WORKERS 0
+#define DEFAULT_MAX_WORKERS 0
 
 int parse_environment_variables(const char* path, environment_variable_t* env_vars) {
     if (!env_vars || !path) {
@@ -25,6 +32,13 @@ int parse_environment_variables(const char* path, environment_variable_t* env_va
     env_vars->priority_timeouts[2] = DEFAULT_PRIORITY_TIMEOUT_HIGH;
     env_vars->aging_start_seconds = DEFAULT_AGING_START;
     env_vars->aging_step_seconds = DEFAULT_AGING_STEP;
+    env_vars->mq_batch_size = DEFAULT_MQ_BATCH_SIZE;
+    env_vars->mq_shards = DEFAULT_MQ_SHARDS;
+    env_vars->mq_max_messages = DEFAULT_MQ_MAX_MESSAGES;
+    env_vars->mq_message_size = DEFAULT_MQ_MESSAGE_SIZE;
+    env_vars->batch_window_ms = DEFAULT_BATCH_WINDOW_MS;
+    env_vars->min_workers = DEFAULT_MIN_WORKERS;
+    env_vars->max_workers = DEFAULT_MAX_WORKERS;
     free(env_vars->queue);
     env_vars->queue = NULL;
 
@@ -71,6 +85,20 @@ int parse_environment_variables(const char* path, environment_variable_t* env_va
                 env_vars->aging_start_seconds = (unsigned int)atoi(tok_value);
             } else if (strcmp(tok_key, "aging_step") == 0) {
                 env_vars->aging_step_seconds = (unsigned int)atoi(tok_value);
+            } else if (strcmp(tok_key, "mq_batch_size") == 0) {
+                env_vars->mq_batch_size = (unsigned int)atoi(tok_value);
+            } else if (strcmp(tok_key, "mq_shards") == 0) {
+                env_vars->mq_shards = (unsigned int)atoi(tok_value);
+            } else if (strcmp(tok_key, "mq_max_messages") == 0) {
+                env_vars->mq_max_messages = (unsigned int)atoi(tok_value);
+            } else if (strcmp(tok_key, "mq_message_size") == 0) {
+                env_vars->mq_message_size = (unsigned int)atoi(tok_value);
+            } else if (strcmp(tok_key, "batch_window_ms") == 0) {
+                env_vars->batch_window_ms = (unsigned int)atoi(tok_value);
+            } else if (strcmp(tok_key, "min_workers") == 0) {
+                env_vars->min_workers = (unsigned int)atoi(tok_value);
+            } else if (strcmp(tok_key, "max_workers") == 0) {
+                env_vars->max_workers = (unsigned int)atoi(tok_value);
             }
         }
     }
@@ -83,7 +111,7 @@ int parse_environment_variables(const char* path, environment_variable_t* env_va
         result = -1;
     } else if (result == 0) {
         LOG_FILE_PARSING("ENV-PARSE-SUCCESS",
-                         "Parsed environment queue='%s' height=%d width=%d timeout=[%u,%u,%u] aging_start=%u aging_step=%u",
+                         "Parsed environment queue='%s' height=%d width=%d timeout=[%u,%u,%u] aging_start=%u aging_step=%u mq_batch=%u mq_shards=%u mq_max_messages=%u mq_message_size=%u batch_window_ms=%u min_workers=%u max_workers=%u",
                          env_vars->queue,
                          env_vars->height,
                          env_vars->width,
@@ -91,7 +119,14 @@ int parse_environment_variables(const char* path, environment_variable_t* env_va
                          env_vars->priority_timeouts[1],
                          env_vars->priority_timeouts[2],
                          env_vars->aging_start_seconds,
-                         env_vars->aging_step_seconds);
+                         env_vars->aging_step_seconds,
+                         env_vars->mq_batch_size,
+                         env_vars->mq_shards,
+                         env_vars->mq_max_messages,
+                         env_vars->mq_message_size,
+                         env_vars->batch_window_ms,
+                         env_vars->min_workers,
+                         env_vars->max_workers);
     }
 
     return result;
@@ -8,6 +8,13 @@ typedef struct environment_variable_t {
     unsigned int priority_timeouts[3];
     unsigned int aging_start_seconds;
     unsigned int aging_step_seconds;
+    unsigned int mq_batch_size;
+    unsigned int mq_shards;
+    unsigned int mq_max_messages; // 0 = largest depth the system allows
+    unsigned int mq_message_size; // 0 = built-in default
+    unsigned int batch_window_ms; // 0 = dispatch one emergency at a time
+    unsigned int min_workers;     // 0 = built-in default
+    unsigned int max_workers;     // 0 = online processors
 } environment_variable_t;
 
 
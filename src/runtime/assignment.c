@@ -0,0 +1,151 @@
+#include "assignment.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+void assignment_solver_init(assignment_solver_t* solver) {
+    if (solver) {
+        memset(solver, 0, sizeof(*solver));
+    }
+}
+
+void assignment_solver_destroy(assignment_solver_t* solver) {
+    if (!solver) {
+        return;
+    }
+
+    free(solver->row_potential);
+    free(solver->col_potential);
+    free(solver->slack);
+    free(solver->col_owner);
+    free(solver->way);
+    free(solver->used);
+    memset(solver, 0, sizeof(*solver));
+}
+
+static int assignment_reserve(assignment_solver_t* solver, size_t rows, size_t cols) {
+    if (rows + 1 > solver->row_capacity) {
+        long long* row_potential = realloc(solver->row_potential, (rows + 1) * sizeof(long long));
+        if (!row_potential) {
+            return -1;
+        }
+        solver->row_potential = row_potential;
+        solver->row_capacity = rows + 1;
+    }
+
+    if (cols + 1 > solver->col_capacity) {
+        size_t capacity = cols + 1;
+        long long* col_potential = realloc(solver->col_potential, capacity * sizeof(long long));
+        if (col_potential) {
+            solver->col_potential = col_potential;
+        }
+        long long* slack = realloc(solver->slack, capacity * sizeof(long long));
+        if (slack) {
+            solver->slack = slack;
+        }
+        int* col_owner = realloc(solver->col_owner, capacity * sizeof(int));
+        if (col_owner) {
+            solver->col_owner = col_owner;
+        }
+        int* way = realloc(solver->way, capacity * sizeof(int));
+        if (way) {
+            solver->way = way;
+        }
+        unsigned char* used = realloc(solver->used, capacity);
+        if (used) {
+            solver->used = used;
+        }
+        if (!col_potential || !slack || !col_owner || !way || !used) {
+            return -1;
+        }
+        solver->col_capacity = capacity;
+    }
+
+    return 0;
+}
+
+// Indices below are 1-based; column 0 is the virtual column the row being
+// added starts from.
+int assignment_solve(assignment_solver_t* solver,
+                     const long long* cost,
+                     size_t rows,
+                     size_t cols,
+                     int* row_to_col,
+                     long long* out_total) {
+    if (!solver || (rows > 0 && (!cost || !row_to_col)) || rows > cols || cols >= (size_t)INT_MAX) {
+        return -1;
+    }
+    if (assignment_reserve(solver, rows, cols) != 0) {
+        return -1;
+    }
+
+    long long* u = solver->row_potential;
+    long long* v = solver->col_potential;
+    long long* slack = solver->slack;
+    int* owner = solver->col_owner;
+    int* way = solver->way;
+    unsigned char* used = solver->used;
+
+    memset(u, 0, (rows + 1) * sizeof(long long));
+    memset(v, 0, (cols + 1) * sizeof(long long));
+    memset(owner, 0, (cols + 1) * sizeof(int));
+
+    for (size_t row = 1; row <= rows; ++row) {
+        owner[0] = (int)row;
+        size_t col0 = 0;
+        for (size_t j = 0; j <= cols; ++j) {
+            slack[j] = LLONG_MAX;
+            used[j] = 0;
+        }
+
+        do {
+            used[col0] = 1;
+            size_t i0 = (size_t)owner[col0];
+            const long long* costs = &cost[(i0 - 1) * cols];
+            long long delta = LLONG_MAX;
+            size_t col1 = 0;
+            for (size_t j = 1; j <= cols; ++j) {
+                if (used[j]) {
+                    continue;
+                }
+                long long reduced = costs[j - 1] - u[i0] - v[j];
+                if (reduced < slack[j]) {
+                    slack[j] = reduced;
+                    way[j] = (int)col0;
+                }
+                if (slack[j] < delta) {
+                    delta = slack[j];
+                    col1 = j;
+                }
+            }
+            for (size_t j = 0; j <= cols; ++j) {
+                if (used[j]) {
+                    u[owner[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    slack[j] -= delta;
+                }
+            }
+            col0 = col1;
+        } while (owner[col0] != 0);
+
+        do {
+            size_t col1 = (size_t)way[col0];
+            owner[col0] = owner[col1];
+            col0 = col1;
+        } while (col0 != 0);
+    }
+
+    long long total = 0;
+    for (size_t j = 1; j <= cols; ++j) {
+        if (owner[j] != 0) {
+            row_to_col[owner[j] - 1] = (int)(j - 1);
+            total += cost[(size_t)(owner[j] - 1) * cols + (j - 1)];
+        }
+    }
+    if (out_total) {
+        *out_total = total;
+    }
+    return 0;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stddef.h>
+
+// Reusable buffers for the assignment solver; grown on demand.
+typedef struct assignment_solver_t {
+    long long* row_potential;
+    long long* col_potential;
+    long long* slack;
+    int* col_owner;
+    int* way;
+    unsigned char* used;
+    size_t row_capacity;
+    size_t col_capacity;
+} assignment_solver_t;
+
+void assignment_solver_init(assignment_solver_t* solver);
+void assignment_solver_destroy(assignment_solver_t* solver);
+
+// Minimum-cost assignment of every row to a distinct column (Hungarian
+// method with shortest augmenting paths, O(rows^2 * cols)). cost is
+// row-major, rows x cols, with rows <= cols and every cost non-negative.
+// row_to_col receives the column of each row. Returns -1 on bad arguments
+// or allocation failure.
+int assignment_solve(assignment_solver_t* solver,
+                     const long long* cost,
+                     size_t rows,
+                     size_t cols,
+                     int* row_to_col,
+                     long long* out_total);
@@ -0,0 +1,51 @@
+#define _POSIX_C_SOURCE 200809L
+#include "clock.h"
+
+void runtime_clock_init_real(runtime_clock_t* source) {
+    if (!source) {
+        return;
+    }
+    source->kind = RUNTIME_CLOCK_REAL;
+    atomic_init(&source->virtual_now, 0);
+}
+
+void runtime_clock_init_virtual(runtime_clock_t* source, time_t start) {
+    if (!source) {
+        return;
+    }
+    source->kind = RUNTIME_CLOCK_VIRTUAL;
+    atomic_init(&source->virtual_now, (long long)start);
+}
+
+time_t runtime_clock_now(const runtime_clock_t* source) {
+    if (runtime_clock_is_virtual(source)) {
+        return (time_t)atomic_load(&source->virtual_now);
+    }
+    return time(NULL);
+}
+
+void runtime_clock_advance(runtime_clock_t* source, time_t to) {
+    if (!runtime_clock_is_virtual(source)) {
+        return;
+    }
+
+    long long current = atomic_load(&source->virtual_now);
+    while ((long long)to > current &&
+           !atomic_compare_exchange_weak(&source->virtual_now, &current, (long long)to)) {
+    }
+}
+
+int runtime_clock_wait_until(const runtime_clock_t* source,
+                             pthread_cond_t* cond,
+                             pthread_mutex_t* mutex,
+                             time_t deadline) {
+    if (runtime_clock_is_virtual(source)) {
+        if (runtime_clock_now(source) >= deadline) {
+            return 0;
+        }
+        return pthread_cond_wait(cond, mutex);
+    }
+
+    struct timespec wake = {.tv_sec = deadline, .tv_nsec = 0};
+    return pthread_cond_timedwait(cond, mutex, &wake);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <time.h>
+
+typedef enum runtime_clock_kind_t {
+    RUNTIME_CLOCK_REAL = 0,
+    RUNTIME_CLOCK_VIRTUAL
+} runtime_clock_kind_t;
+
+// Source of "now" for the runtime, in whole seconds like time(NULL). The
+// real backend reads the wall clock; the virtual one only moves when
+// runtime_clock_advance() is called, which lets the simulator jump from one
+// scheduled event to the next. A NULL clock behaves like a real one.
+typedef struct runtime_clock_t {
+    runtime_clock_kind_t kind;
+    atomic_llong virtual_now;
+} runtime_clock_t;
+
+void runtime_clock_init_real(runtime_clock_t* source);
+void runtime_clock_init_virtual(runtime_clock_t* source, time_t start);
+
+time_t runtime_clock_now(const runtime_clock_t* source);
+
+static inline bool runtime_clock_is_virtual(const runtime_clock_t* source) {
+    return source && source->kind == RUNTIME_CLOCK_VIRTUAL;
+}
+
+// Moves a virtual clock forward to the given time; earlier times and real
+// clocks are ignored.
+void runtime_clock_advance(runtime_clock_t* source, time_t to);
+
+// Waits on cond (mutex held) until signalled or, on the real clock, until
+// the deadline passes. A virtual deadline is only reached by advancing the
+// clock, so the caller must be signalled when that happens.
+int runtime_clock_wait_until(const runtime_clock_t* source,
+                             pthread_cond_t* cond,
+                             pthread_mutex_t* mutex,
+                             time_t deadline);
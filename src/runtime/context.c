@@ -30,6 +30,8 @@ void app_context_cleanup(app_context_t* ctx) {
     ctx->rescuer_types = NULL;
     ctx->rescuer_type_count = 0;
 
+    emergency_type_index_destroy(&ctx->emergency_index);
+
     free_emergency_types(ctx->emergency_types);
     ctx->emergency_types = NULL;
     ctx->emergency_type_count = 0;
@@ -5,6 +5,7 @@
 #include "../../parse_env.h"
 #include "../../rescuers.h"
 #include "../../emergency_types.h"
+#include "type_index.h"
 
 typedef struct app_context_t {
     environment_variable_t environment;
@@ -14,6 +15,7 @@ typedef struct app_context_t {
     size_t rescuer_twin_count;
     emergency_type_t* emergency_types;
     size_t emergency_type_count;
+    emergency_type_index_t emergency_index;
 } app_context_t;
 
 void app_context_init(app_context_t* ctx);
@@ -0,0 +1,124 @@
+#include "handoff_ring.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+int handoff_ring_init(handoff_ring_t* ring, size_t capacity) {
+    if (!ring || capacity == 0) {
+        return -1;
+    }
+
+    size_t rounded = 2;
+    while (rounded < capacity) {
+        rounded *= 2;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    ring->slots = calloc(rounded, sizeof(handoff_slot_t));
+    if (!ring->slots) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < rounded; ++i) {
+        atomic_init(&ring->slots[i].sequence, i);
+        ring->slots[i].item = NULL;
+    }
+    ring->mask = rounded - 1;
+
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->pushed, 0);
+    atomic_init(&ring->overflows, 0);
+    atomic_init(&ring->high_water, 0);
+    return 0;
+}
+
+void handoff_ring_destroy(handoff_ring_t* ring) {
+    if (!ring) {
+        return;
+    }
+
+    free(ring->slots);
+    ring->slots = NULL;
+    ring->mask = 0;
+}
+
+// Called after the slot is published: with several producers the
+// consumer may already be past position, and then there is nothing to note.
+static void handoff_ring_note_occupancy(handoff_ring_t* ring, size_t position) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head > position) {
+        return;
+    }
+    size_t occupancy = position + 1 - head;
+    size_t seen = atomic_load_explicit(&ring->high_water, memory_order_relaxed);
+    while (occupancy > seen &&
+           !atomic_compare_exchange_weak_explicit(&ring->high_water,
+                                                  &seen,
+                                                  occupancy,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+bool handoff_ring_push(handoff_ring_t* ring, void* item) {
+    if (!ring || !ring->slots) {
+        return false;
+    }
+
+    size_t position = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    while (true) {
+        handoff_slot_t* slot = &ring->slots[position & ring->mask];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->tail,
+                                                      &position,
+                                                      position + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                slot->item = item;
+                atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+                atomic_fetch_add_explicit(&ring->pushed, 1, memory_order_relaxed);
+                handoff_ring_note_occupancy(ring, position);
+                return true;
+            }
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&ring->overflows, 1, memory_order_relaxed);
+            return false;
+        } else {
+            position = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        }
+    }
+}
+
+size_t handoff_ring_pop_bulk(handoff_ring_t* ring, void** out, size_t max_items) {
+    if (!ring || !ring->slots || !out) {
+        return 0;
+    }
+
+    size_t position = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t count = 0;
+
+    while (count < max_items) {
+        handoff_slot_t* slot = &ring->slots[position & ring->mask];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (sequence != position + 1) {
+            break;
+        }
+
+        out[count++] = slot->item;
+        slot->item = NULL;
+        atomic_store_explicit(&slot->sequence, position + ring->mask + 1, memory_order_release);
+        ++position;
+    }
+
+    atomic_store_explicit(&ring->head, position, memory_order_relaxed);
+    return count;
+}
+
+size_t handoff_ring_capacity(const handoff_ring_t* ring) {
+    return ring && ring->slots ? ring->mask + 1 : 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef HANDOFF_RING_CACHELINE
+#define HANDOFF_RING_CACHELINE 64
+#endif
+
+typedef struct handoff_slot_t {
+    atomic_size_t sequence;
+    void* item;
+} handoff_slot_t;
+
+// Bounded lock-free multi-producer/single-consumer ring of pointers
+// (Vyukov's sequence-numbered slots). Producers claim slots with a CAS on
+// tail; the single consumer advances head with plain stores.
+typedef struct handoff_ring_t {
+    handoff_slot_t* slots;
+    size_t mask;
+
+    _Alignas(HANDOFF_RING_CACHELINE) atomic_size_t tail;
+    _Alignas(HANDOFF_RING_CACHELINE) atomic_size_t head;
+
+    _Alignas(HANDOFF_RING_CACHELINE) atomic_ullong pushed;
+    atomic_ullong overflows;
+    atomic_size_t high_water;
+} handoff_ring_t;
+
+// capacity is rounded up to a power of two.
+int handoff_ring_init(handoff_ring_t* ring, size_t capacity);
+void handoff_ring_destroy(handoff_ring_t* ring);
+
+// Safe to call from any number of threads. Returns false and counts an
+// overflow when the ring is full.
+bool handoff_ring_push(handoff_ring_t* ring, void* item);
+
+// Single consumer only. Returns the number of items written to out.
+size_t handoff_ring_pop_bulk(handoff_ring_t* ring, void** out, size_t max_items);
+
+size_t handoff_ring_capacity(const handoff_ring_t* ring);
@@ -0,0 +1,281 @@
+#include "rescuer_grid.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int clamp_cell(int value, int cell_size, int count) {
+    if (value < 0) {
+        return 0;
+    }
+    int cell = value / cell_size;
+    return cell < count ? cell : count - 1;
+}
+
+// Distance along one axis from v to a cell. Border cells extend to
+// infinity, so units outside the grid still have a valid lower bound.
+static long long axis_gap(int v, int cell, int count, int cell_size) {
+    if (cell > 0) {
+        long long lo = (long long)cell * cell_size;
+        if (v < lo) {
+            return lo - v;
+        }
+    }
+    if (cell < count - 1) {
+        long long hi = (long long)(cell + 1) * cell_size - 1;
+        if (v > hi) {
+            return v - hi;
+        }
+    }
+    return 0;
+}
+
+// Smallest r with r * r >= n.
+static unsigned long long ceil_sqrt(unsigned long long n) {
+    if (n < 2) {
+        return n;
+    }
+    // Newton's iteration from above settles on floor(sqrt(n)).
+    unsigned long long r = n / 2 < 0xFFFFFFFFULL ? n / 2 : 0xFFFFFFFFULL;
+    for (unsigned long long next = (r + n / r) / 2; next < r; next = (r + n / r) / 2) {
+        r = next;
+    }
+    return r * r < n ? r + 1 : r;
+}
+
+int rescuer_grid_init(rescuer_grid_t* grid,
+                      int width,
+                      int height,
+                      const rescuer_type_t* types,
+                      size_t type_count,
+                      const int* type_of,
+                      size_t rescuer_count) {
+    if (!grid || (type_count > 0 && !types) || (rescuer_count > 0 && !type_of)) {
+        return -1;
+    }
+
+    memset(grid, 0, sizeof(*grid));
+
+    int cell_size = RESCUER_GRID_MIN_CELL;
+    if (width > 0 && height > 0 && rescuer_count > 0) {
+        // Area per unit, rounded up; its square root rounded up is the
+        // same side as that of the exact area.
+        unsigned long long cells = (unsigned long long)width * (unsigned long long)height;
+        unsigned long long factor = (unsigned long long)(type_count ? type_count : 1) * RESCUER_GRID_UNITS_PER_CELL;
+        unsigned long long area_per_unit;
+        if (factor > 0 && cells > ULLONG_MAX / factor) {
+            area_per_unit = ULLONG_MAX / rescuer_count;
+        } else {
+            unsigned long long total = cells * factor;
+            area_per_unit = total / rescuer_count + (total % rescuer_count != 0);
+        }
+        unsigned long long side = ceil_sqrt(area_per_unit);
+        if (side > (unsigned long long)cell_size) {
+            cell_size = side < (unsigned long long)INT_MAX ? (int)side : INT_MAX;
+        }
+    }
+
+    grid->cell_size = cell_size;
+    grid->columns = width > 0 ? (int)(((long long)width + cell_size - 1) / cell_size) : 1;
+    grid->rows = height > 0 ? (int)(((long long)height + cell_size - 1) / cell_size) : 1;
+    grid->type_count = type_count;
+    grid->rescuer_count = rescuer_count;
+    grid->types = types;
+    grid->type_of = type_of;
+
+    size_t bucket_count = type_count * ((size_t)grid->columns * (size_t)grid->rows + 1);
+    grid->heads = malloc((bucket_count ? bucket_count : 1) * sizeof(int));
+    grid->base_tails = malloc((type_count ? type_count : 1) * sizeof(int));
+    grid->in_cells = calloc(type_count ? type_count : 1, sizeof(size_t));
+    grid->indexed = calloc(type_count ? type_count : 1, sizeof(size_t));
+    grid->next = malloc((rescuer_count ? rescuer_count : 1) * sizeof(int));
+    grid->prev = malloc((rescuer_count ? rescuer_count : 1) * sizeof(int));
+    grid->bucket = malloc((rescuer_count ? rescuer_count : 1) * sizeof(int));
+    if (!grid->heads || !grid->base_tails || !grid->in_cells || !grid->indexed || !grid->next || !grid->prev ||
+        !grid->bucket) {
+        rescuer_grid_destroy(grid);
+        return -1;
+    }
+
+    for (size_t i = 0; i < bucket_count; ++i) {
+        grid->heads[i] = -1;
+    }
+    for (size_t i = 0; i < type_count; ++i) {
+        grid->base_tails[i] = -1;
+    }
+    for (size_t i = 0; i < rescuer_count; ++i) {
+        grid->next[i] = -1;
+        grid->prev[i] = -1;
+        grid->bucket[i] = -1;
+    }
+
+    return 0;
+}
+
+void rescuer_grid_destroy(rescuer_grid_t* grid) {
+    if (!grid) {
+        return;
+    }
+
+    free(grid->heads);
+    free(grid->base_tails);
+    free(grid->in_cells);
+    free(grid->indexed);
+    free(grid->next);
+    free(grid->prev);
+    free(grid->bucket);
+    memset(grid, 0, sizeof(*grid));
+}
+
+static int cell_bucket(const rescuer_grid_t* grid, int type_id, int column, int row) {
+    return (type_id * grid->rows + row) * grid->columns + column;
+}
+
+static int base_bucket(const rescuer_grid_t* grid, int type_id) {
+    return (int)grid->type_count * grid->rows * grid->columns + type_id;
+}
+
+void rescuer_grid_remove(rescuer_grid_t* grid, int index) {
+    int bucket = grid->bucket[index];
+    if (bucket < 0) {
+        return;
+    }
+
+    int next = grid->next[index];
+    int prev = grid->prev[index];
+    if (prev >= 0) {
+        grid->next[prev] = next;
+    } else {
+        grid->heads[bucket] = next;
+    }
+    int type_id = grid->type_of[index];
+    if (next >= 0) {
+        grid->prev[next] = prev;
+    } else if (bucket == base_bucket(grid, type_id)) {
+        grid->base_tails[type_id] = prev;
+    }
+    if (bucket != base_bucket(grid, type_id)) {
+        grid->in_cells[type_id]--;
+    }
+    grid->indexed[type_id]--;
+
+    grid->next[index] = -1;
+    grid->prev[index] = -1;
+    grid->bucket[index] = -1;
+}
+
+void rescuer_grid_place(rescuer_grid_t* grid, int index, const rescuer_digital_twin_t* rescuer) {
+    rescuer_grid_remove(grid, index);
+
+    int type_id = grid->type_of[index];
+    if (type_id < 0 || (size_t)type_id >= grid->type_count) {
+        return;
+    }
+
+    const rescuer_type_t* type = &grid->types[type_id];
+    if (rescuer->status == IDLE && rescuer->x == type->x && rescuer->y == type->y) {
+        int bucket = base_bucket(grid, type_id);
+        int tail = grid->base_tails[type_id];
+        grid->prev[index] = tail;
+        grid->next[index] = -1;
+        if (tail >= 0) {
+            grid->next[tail] = index;
+        } else {
+            grid->heads[bucket] = index;
+        }
+        grid->base_tails[type_id] = index;
+        grid->bucket[index] = bucket;
+        grid->indexed[type_id]++;
+        return;
+    }
+
+    int bucket = cell_bucket(grid,
+                             type_id,
+                             clamp_cell(rescuer->x, grid->cell_size, grid->columns),
+                             clamp_cell(rescuer->y, grid->cell_size, grid->rows));
+    int head = grid->heads[bucket];
+    grid->next[index] = head;
+    grid->prev[index] = -1;
+    if (head >= 0) {
+        grid->prev[head] = index;
+    }
+    grid->heads[bucket] = index;
+    grid->bucket[index] = bucket;
+    grid->in_cells[type_id]++;
+    grid->indexed[type_id]++;
+}
+
+int rescuer_grid_base_head(const rescuer_grid_t* grid, int type_id) {
+    if (!grid || type_id < 0 || (size_t)type_id >= grid->type_count) {
+        return -1;
+    }
+    return grid->heads[base_bucket(grid, type_id)];
+}
+
+int rescuer_grid_nearest(const rescuer_grid_t* grid,
+                         int type_id,
+                         const rescuer_digital_twin_t* pool,
+                         int x,
+                         int y,
+                         time_t now) {
+    if (!grid || !pool || type_id < 0 || (size_t)type_id >= grid->type_count) {
+        return -1;
+    }
+
+    int best_index = grid->heads[base_bucket(grid, type_id)];
+    bool best_at_base = best_index >= 0;
+    long long best_score = LLONG_MAX;
+    if (best_at_base) {
+        const rescuer_type_t* type = &grid->types[type_id];
+        long long dx = (long long)type->x - x;
+        long long dy = (long long)type->y - y;
+        best_score = (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+    }
+
+    int center_column = clamp_cell(x, grid->cell_size, grid->columns);
+    int center_row = clamp_cell(y, grid->cell_size, grid->rows);
+    int max_ring = grid->columns > grid->rows ? grid->columns : grid->rows;
+    size_t unseen = grid->in_cells[type_id];
+
+    for (int ring = 0; ring < max_ring && unseen > 0; ++ring) {
+        // Every cell of this ring is at least (ring - 1) full cells away.
+        if (ring > 0 && (long long)(ring - 1) * grid->cell_size + 1 > best_score) {
+            break;
+        }
+
+        for (int row = center_row - ring; row <= center_row + ring; ++row) {
+            if (row < 0 || row >= grid->rows) {
+                continue;
+            }
+            bool edge_row = row == center_row - ring || row == center_row + ring;
+            int step = edge_row ? 1 : 2 * ring;
+            for (int column = center_column - ring; column <= center_column + ring; column += step) {
+                if (column < 0 || column >= grid->columns) {
+                    continue;
+                }
+
+                int head = grid->heads[cell_bucket(grid, type_id, column, row)];
+                if (head < 0) {
+                    continue;
+                }
+                long long bound = axis_gap(x, column, grid->columns, grid->cell_size) +
+                                  axis_gap(y, row, grid->rows, grid->cell_size);
+                if (bound > best_score) {
+                    continue;
+                }
+
+                for (int idx = head; idx >= 0; idx = grid->next[idx]) {
+                    --unseen;
+                    long long score = rescuer_grid_score(&pool[idx], x, y, now);
+                    if (score < best_score || (score == best_score && !best_at_base && idx < best_index)) {
+                        best_score = score;
+                        best_index = idx;
+                        best_at_base = false;
+                    }
+                }
+            }
+        }
+    }
+
+    return best_index;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+#include "../../rescuers.h"
+
+// Cells are sized for this many units of a type per cell if the whole
+// fleet were spread evenly; most units are usually at base, so the cells
+// actually hold fewer.
+#ifndef RESCUER_GRID_UNITS_PER_CELL
+#define RESCUER_GRID_UNITS_PER_CELL 1
+#endif
+
+// Minimum side of a grid cell, in grid units.
+#ifndef RESCUER_GRID_MIN_CELL
+#define RESCUER_GRID_MIN_CELL 8
+#endif
+
+// Spatial index of the rescuers that can be dispatched (IDLE or
+// RETURNING_TO_BASE), one uniform grid of buckets per rescuer type. Units
+// idle at their type's base are interchangeable, so they are kept apart in
+// a FIFO pool per type and scored once, by the distance to the base; only
+// units away from base go into grid cells. Buckets and pools are
+// intrusive doubly linked lists over rescuer indices: placing, moving and
+// removing a unit are O(1).
+typedef struct rescuer_grid_t {
+    int cell_size;
+    int columns;
+    int rows;
+    size_t type_count;
+    size_t rescuer_count;
+    const rescuer_type_t* types; // bases, indexed by rescuer type ID
+    const int* type_of;          // per rescuer: rescuer type ID, -1 if never indexed
+    int* heads;      // type_count * rows * columns cell buckets, then type_count base pools; -1 when empty
+    int* base_tails; // per type: last unit of the base pool
+    size_t* in_cells; // per type: units filed in grid cells
+    size_t* indexed;  // per type: units in the index, cells and base pool
+    int* next;       // per rescuer
+    int* prev;       // per rescuer
+    int* bucket;     // per rescuer: bucket it sits in, -1 when not indexed
+} rescuer_grid_t;
+
+// types and type_of must stay valid for the grid's lifetime. A width or
+// height that is not positive gives a single cell.
+int rescuer_grid_init(rescuer_grid_t* grid,
+                      int width,
+                      int height,
+                      const rescuer_type_t* types,
+                      size_t type_count,
+                      const int* type_of,
+                      size_t rescuer_count);
+void rescuer_grid_destroy(rescuer_grid_t* grid);
+
+static inline bool rescuer_grid_contains(const rescuer_grid_t* grid, int index) {
+    return grid->bucket[index] >= 0;
+}
+
+static inline size_t rescuer_grid_count(const rescuer_grid_t* grid, int type_id) {
+    return grid->indexed[type_id];
+}
+
+// Oldest unit idle at its type's base, or -1.
+int rescuer_grid_base_head(const rescuer_grid_t* grid, int type_id);
+
+// What the index ranks a unit by for a place: the Manhattan distance plus,
+// for a unit still returning to base, the seconds until it gets there.
+static inline long long rescuer_grid_score(const rescuer_digital_twin_t* rescuer, int x, int y, time_t now) {
+    long long dx = (long long)rescuer->x - x;
+    long long dy = (long long)rescuer->y - y;
+    long long score = (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+    if (rescuer->status == RETURNING_TO_BASE && rescuer->return_available_at > now) {
+        score += (long long)(rescuer->return_available_at - now);
+    }
+    return score;
+}
+
+// (Re)files a unit according to its current status and position; a unit
+// idle at base goes to the back of its type's pool.
+void rescuer_grid_place(rescuer_grid_t* grid, int index, const rescuer_digital_twin_t* rescuer);
+// No-op for a unit that is not indexed.
+void rescuer_grid_remove(rescuer_grid_t* grid, int index);
+
+// Returns the indexed rescuer of the given type that minimises the
+// Manhattan distance to (x, y) plus, for a unit still returning to base,
+// the seconds until it gets there, or -1 if the type has none. Ties go to
+// the oldest unit idle at base, then to the lowest index. Cells are visited
+// in rings around the target and the search stops once no unvisited cell
+// can do better or every unit of the type in the cells has been seen.
+int rescuer_grid_nearest(const rescuer_grid_t* grid,
+                         int type_id,
+                         const rescuer_digital_twin_t* pool,
+                         int x,
+                         int y,
+                         time_t now);
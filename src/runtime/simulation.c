@@ -0,0 +1,232 @@
+#define _POSIX_C_SOURCE 200809L
+#include "simulation.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../logging.h"
+#include "../../mq_message.h"
+
+#ifndef SIMULATION_INJECT_BATCH
+#define SIMULATION_INJECT_BATCH 64
+#endif
+
+typedef struct simulation_entry_t {
+    char name[EMERGENCY_NAME_LENGTH];
+    int x;
+    int y;
+    time_t offset;
+    size_t line;
+} simulation_entry_t;
+
+static int simulation_compare_entries(const void* a, const void* b) {
+    const simulation_entry_t* lhs = a;
+    const simulation_entry_t* rhs = b;
+    if (lhs->offset != rhs->offset) {
+        return lhs->offset < rhs->offset ? -1 : 1;
+    }
+    return lhs->line < rhs->line ? -1 : (lhs->line > rhs->line);
+}
+
+static int simulation_load(const char* path, simulation_entry_t** out_entries, size_t* out_count) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        LOG_SYSTEM("SIM-ERROR", "Unable to open scenario '%s': %s", path, strerror(errno));
+        return -1;
+    }
+
+    simulation_entry_t* entries = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    char* line = NULL;
+    size_t line_capacity = 0;
+    size_t line_number = 0;
+    int result = 0;
+
+    while (getline(&line, &line_capacity, file) != -1) {
+        ++line_number;
+        char* p = line;
+        while (*p == ' ' || *p == '\t') {
+            ++p;
+        }
+        if (*p == '\0' || *p == '\n' || *p == '#') {
+            continue;
+        }
+
+        if (count == capacity) {
+            size_t new_capacity = capacity ? capacity * 2 : 64;
+            simulation_entry_t* grown = realloc(entries, new_capacity * sizeof(*entries));
+            if (!grown) {
+                result = -1;
+                break;
+            }
+            entries = grown;
+            capacity = new_capacity;
+        }
+
+        simulation_entry_t* entry = &entries[count];
+        double delay = 0.0;
+        char extra;
+        if (sscanf(p, "%63s %d %d %lf %c", entry->name, &entry->x, &entry->y, &delay, &extra) != 4 ||
+            delay < 0.0) {
+            LOG_SYSTEM("SIM-ERROR", "%s:%zu: expected '<name> <x> <y> <delay>'", path, line_number);
+            result = -1;
+            break;
+        }
+        // The runtime clock has one-second resolution.
+        entry->offset = (time_t)delay;
+        entry->line = line_number;
+        ++count;
+    }
+
+    free(line);
+    fclose(file);
+
+    if (result != 0) {
+        free(entries);
+        return -1;
+    }
+
+    qsort(entries, count, sizeof(*entries), simulation_compare_entries);
+    *out_entries = entries;
+    *out_count = count;
+    return 0;
+}
+
+// Hands every entry due at the current virtual time to the runtime. Entries
+// go through the same validation as queue messages, timestamped now.
+static size_t simulation_inject_due(runtime_state_t* state,
+                                    const environment_variable_t* environment,
+                                    const simulation_entry_t* entries,
+                                    size_t count,
+                                    size_t* next,
+                                    time_t start,
+                                    runtime_simulation_stats_t* stats) {
+    time_t now = runtime_state_now(state);
+    const mq_parse_limits_t limits = {
+        .grid_width = environment ? environment->width : 0,
+        .grid_height = environment ? environment->height : 0,
+        .now = now,
+        .type_count = state->type_index->count,
+    };
+
+    emergency_request_t batch[SIMULATION_INJECT_BATCH];
+    size_t batch_count = 0;
+    size_t injected = 0;
+
+    while (*next < count && start + entries[*next].offset <= now) {
+        const simulation_entry_t* entry = &entries[(*next)++];
+        char message[EMERGENCY_NAME_LENGTH + 64];
+        int length = snprintf(message, sizeof(message), "%s;%d;%d;%lld", entry->name, entry->x, entry->y, (long long)now);
+
+        emergency_request_t* request = &batch[batch_count];
+        mq_parse_status_t status = mq_message_parse(message, (size_t)length, &limits, request);
+        if (status == MQ_PARSE_OK) {
+            request->type_id = emergency_type_index_lookup(state->type_index, request->emergency_name);
+            if (request->type_id < 0) {
+                status = MQ_PARSE_UNKNOWN_TYPE;
+            }
+        }
+        if (status != MQ_PARSE_OK) {
+            LOG_SYSTEM("SIM-INVALID",
+                       "Scenario line %zu rejected (%s): '%s'",
+                       entry->line,
+                       mq_parse_status_to_string(status),
+                       message);
+            stats->rejected++;
+            continue;
+        }
+
+        if (++batch_count == SIMULATION_INJECT_BATCH) {
+            int enqueued = runtime_state_dispatch_batch(state, batch, batch_count);
+            injected += enqueued > 0 ? (size_t)enqueued : 0;
+            batch_count = 0;
+        }
+    }
+
+    if (batch_count > 0) {
+        int enqueued = runtime_state_dispatch_batch(state, batch, batch_count);
+        injected += enqueued > 0 ? (size_t)enqueued : 0;
+    }
+
+    stats->injected += injected;
+    return injected;
+}
+
+int runtime_simulation_run(runtime_state_t* state,
+                           runtime_clock_t* clock,
+                           const environment_variable_t* environment,
+                           const char* scenario_path,
+                           runtime_simulation_stats_t* out_stats) {
+    if (!state || !runtime_clock_is_virtual(clock) || state->clock != clock || !scenario_path) {
+        return -1;
+    }
+
+    simulation_entry_t* entries = NULL;
+    size_t count = 0;
+    if (simulation_load(scenario_path, &entries, &count) != 0) {
+        return -1;
+    }
+
+    runtime_simulation_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.virtual_start = runtime_clock_now(clock);
+
+    struct timespec wall_start;
+    struct timespec wall_end;
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+
+    LOG_SYSTEM("SIM-START", "Replaying %zu scenario entries from '%s' on the virtual clock", count, scenario_path);
+
+    size_t next = 0;
+    while (true) {
+        simulation_inject_due(state, environment, entries, count, &next, stats.virtual_start, &stats);
+        stats.steps += runtime_state_settle(state);
+
+        time_t now = runtime_clock_now(clock);
+        time_t target = 0;
+        bool pending = runtime_state_next_timer(state, &target);
+        if (next < count) {
+            time_t arrival = stats.virtual_start + entries[next].offset;
+            if (!pending || arrival < target) {
+                target = arrival;
+            }
+            pending = true;
+        }
+        if (!pending) {
+            break;
+        }
+
+        // Everything due now has been handled, so the next event is strictly
+        // in the future.
+        runtime_clock_advance(clock, target > now ? target : now + 1);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &wall_end);
+    stats.virtual_end = runtime_clock_now(clock);
+    stats.wall_seconds = (double)(wall_end.tv_sec - wall_start.tv_sec) +
+                         (double)(wall_end.tv_nsec - wall_start.tv_nsec) / 1e9;
+
+    pthread_mutex_lock(&state->mutex);
+    if (state->arrivals > 0) {
+        stats.mean_response_seconds = (double)state->arrival_wait_seconds / (double)state->arrivals;
+    }
+    pthread_mutex_unlock(&state->mutex);
+
+    LOG_SYSTEM("SIM-DONE",
+               "Simulated %lld s in %.3f s: injected=%zu rejected=%zu steps=%zu mean_response=%.1fs",
+               (long long)(stats.virtual_end - stats.virtual_start),
+               stats.wall_seconds,
+               stats.injected,
+               stats.rejected,
+               stats.steps,
+               stats.mean_response_seconds);
+
+    free(entries);
+    if (out_stats) {
+        *out_stats = stats;
+    }
+    return 0;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h>
+#include <time.h>
+
+#include "../../parse_env.h"
+#include "clock.h"
+#include "state.h"
+
+typedef struct runtime_simulation_stats_t {
+    size_t injected;       // scenario entries accepted by the runtime
+    size_t rejected;       // entries that failed message validation
+    size_t steps;          // admissions, timer firings and dispatches
+    time_t virtual_start;
+    time_t virtual_end;
+    double wall_seconds;
+    double mean_response_seconds; // request to arrival on scene
+} runtime_simulation_stats_t;
+
+// Replays a scenario on a runtime built over a virtual clock, without
+// worker, monitor or ingest threads. Each line reads
+// "<name> <x> <y> <delay>" like the client's -f files, the delay being
+// seconds from the start of the run. Between events the clock jumps
+// straight to the next arrival or timer expiry, and the run ends once no
+// arrival or timer is left. Returns 0 on success, -1 if the scenario could
+// not be read.
+int runtime_simulation_run(runtime_state_t* state,
+                           runtime_clock_t* clock,
+                           const environment_variable_t* environment,
+                           const char* scenario_path,
+                           runtime_simulation_stats_t* out_stats);
@@ -0,0 +1,209 @@
+#include "slab_allocator.h"
+
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct slab_chunk_t {
+    struct slab_chunk_t* next;
+    size_t count;
+} slab_chunk_t;
+
+typedef struct slab_thread_cache_t {
+    const slab_allocator_t* owner;
+    unsigned long long generation;
+    size_t count;
+    void* objects[SLAB_CACHE_OBJECTS];
+} slab_thread_cache_t;
+
+static _Thread_local slab_thread_cache_t g_slab_cache;
+static atomic_ullong g_slab_generation = 1;
+
+// Live allocators, so a thread cache switching owners can tell whether the
+// one it leaves still exists. Held while handing a cache back, so the
+// owner cannot be destroyed meanwhile.
+static pthread_mutex_t g_slab_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static slab_allocator_t* g_slab_registry;
+
+#define SLAB_ALIGN alignof(max_align_t)
+#define SLAB_ROUND_UP(n) (((n) + SLAB_ALIGN - 1) / SLAB_ALIGN * SLAB_ALIGN)
+
+static inline void* slab_next(void* object) {
+    void* next;
+    memcpy(&next, object, sizeof(next));
+    return next;
+}
+
+static inline void slab_set_next(void* object, void* next) {
+    memcpy(object, &next, sizeof(next));
+}
+
+// Carves a chunk of count objects onto the free list; needs the lock.
+static int slab_grow_locked(slab_allocator_t* slab, size_t count) {
+    size_t header = SLAB_ROUND_UP(sizeof(slab_chunk_t));
+    if (count > (SIZE_MAX - header) / slab->object_size) {
+        return -1;
+    }
+    slab_chunk_t* chunk = malloc(header + count * slab->object_size);
+    if (!chunk) {
+        return -1;
+    }
+    chunk->next = slab->chunks;
+    chunk->count = count;
+    slab->chunks = chunk;
+
+    unsigned char* objects = (unsigned char*)chunk + header;
+    for (size_t i = count; i > 0; --i) {
+        void* object = objects + (i - 1) * slab->object_size;
+        slab_set_next(object, slab->free_list);
+        slab->free_list = object;
+    }
+    slab->free_count += count;
+    slab->capacity += count;
+    return 0;
+}
+
+int slab_allocator_init(slab_allocator_t* slab, size_t object_size, size_t reserve) {
+    if (!slab || object_size == 0 || object_size > SIZE_MAX - SLAB_ALIGN) {
+        return -1;
+    }
+
+    memset(slab, 0, sizeof(*slab));
+    slab->object_size = SLAB_ROUND_UP(object_size < sizeof(void*) ? sizeof(void*) : object_size);
+    slab->generation = atomic_fetch_add(&g_slab_generation, 1);
+    if (pthread_mutex_init(&slab->lock, NULL) != 0) {
+        return -1;
+    }
+    if (reserve > 0 && slab_grow_locked(slab, reserve) != 0) {
+        pthread_mutex_destroy(&slab->lock);
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_slab_registry_lock);
+    slab->next_live = g_slab_registry;
+    g_slab_registry = slab;
+    pthread_mutex_unlock(&g_slab_registry_lock);
+    return 0;
+}
+
+void slab_allocator_destroy(slab_allocator_t* slab) {
+    if (!slab || slab->object_size == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_slab_registry_lock);
+    for (slab_allocator_t** link = &g_slab_registry; *link; link = &(*link)->next_live) {
+        if (*link == slab) {
+            *link = slab->next_live;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_slab_registry_lock);
+
+    if (g_slab_cache.owner == slab && g_slab_cache.generation == slab->generation) {
+        g_slab_cache.owner = NULL;
+        g_slab_cache.count = 0;
+    }
+    while (slab->chunks) {
+        slab_chunk_t* next = slab->chunks->next;
+        free(slab->chunks);
+        slab->chunks = next;
+    }
+    pthread_mutex_destroy(&slab->lock);
+    memset(slab, 0, sizeof(*slab));
+}
+
+static void slab_flush(slab_allocator_t* slab, slab_thread_cache_t* cache, size_t count);
+
+// The calling thread's cache, taken over for slab if it served another;
+// what it held goes back to that allocator unless it is gone, chunks and
+// all.
+static slab_thread_cache_t* slab_thread_cache(const slab_allocator_t* slab) {
+    slab_thread_cache_t* cache = &g_slab_cache;
+    if (cache->owner != slab || cache->generation != slab->generation) {
+        if (cache->count > 0) {
+            pthread_mutex_lock(&g_slab_registry_lock);
+            for (slab_allocator_t* live = g_slab_registry; live; live = live->next_live) {
+                if (live == cache->owner && live->generation == cache->generation) {
+                    slab_flush(live, cache, cache->count);
+                    break;
+                }
+            }
+            pthread_mutex_unlock(&g_slab_registry_lock);
+        }
+        cache->owner = slab;
+        cache->generation = slab->generation;
+        cache->count = 0;
+    }
+    return cache;
+}
+
+void* slab_allocator_alloc(slab_allocator_t* slab) {
+    if (!slab) {
+        return NULL;
+    }
+
+    slab_thread_cache_t* cache = slab_thread_cache(slab);
+    if (cache->count == 0) {
+        pthread_mutex_lock(&slab->lock);
+        if (slab->free_count == 0) {
+            slab_grow_locked(slab, SLAB_CHUNK_OBJECTS);
+        }
+        while (cache->count < SLAB_CACHE_OBJECTS / 2 && slab->free_list) {
+            void* object = slab->free_list;
+            slab->free_list = slab_next(object);
+            --slab->free_count;
+            cache->objects[cache->count++] = object;
+        }
+        pthread_mutex_unlock(&slab->lock);
+        if (cache->count == 0) {
+            return NULL;
+        }
+    }
+    return cache->objects[--cache->count];
+}
+
+// Moves the newest count cached objects to the shared list.
+static void slab_flush(slab_allocator_t* slab, slab_thread_cache_t* cache, size_t count) {
+    pthread_mutex_lock(&slab->lock);
+    for (size_t i = 0; i < count; ++i) {
+        void* object = cache->objects[--cache->count];
+        slab_set_next(object, slab->free_list);
+        slab->free_list = object;
+    }
+    slab->free_count += count;
+    pthread_mutex_unlock(&slab->lock);
+}
+
+void slab_allocator_free(slab_allocator_t* slab, void* object) {
+    if (!slab || !object) {
+        return;
+    }
+
+    slab_thread_cache_t* cache = slab_thread_cache(slab);
+    if (cache->count == SLAB_CACHE_OBJECTS) {
+        slab_flush(slab, cache, SLAB_CACHE_OBJECTS / 2);
+    }
+    cache->objects[cache->count++] = object;
+}
+
+void slab_allocator_release_thread_cache(slab_allocator_t* slab) {
+    if (!slab || g_slab_cache.owner != slab || g_slab_cache.generation != slab->generation) {
+        return;
+    }
+    slab_flush(slab, &g_slab_cache, g_slab_cache.count);
+}
+
+size_t slab_allocator_capacity(slab_allocator_t* slab) {
+    if (!slab) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&slab->lock);
+    size_t capacity = slab->capacity;
+    pthread_mutex_unlock(&slab->lock);
+    return capacity;
+}
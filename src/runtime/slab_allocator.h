@@ -0,0 +1,50 @@
+#pragma once
+
+#include <pthread.h>
+#include <stddef.h>
+
+// Objects a thread keeps for itself before it hands half of them back.
+#ifndef SLAB_CACHE_OBJECTS
+#define SLAB_CACHE_OBJECTS 32
+#endif
+
+// Objects carved at once when the free list runs dry.
+#ifndef SLAB_CHUNK_OBJECTS
+#define SLAB_CHUNK_OBJECTS 64
+#endif
+
+struct slab_chunk_t;
+
+// Fixed-size object allocator. Objects are carved out of chunks that are
+// only returned to the system by slab_allocator_destroy(); a freed object
+// goes to the calling thread's cache, and whole halves of a cache move to
+// and from the shared free list under lock, so most allocations and frees
+// touch neither the lock nor malloc. Each thread caches for one allocator
+// at a time; a thread that moves on to another hands what it cached back
+// to the first, if it still exists.
+typedef struct slab_allocator_t {
+    size_t object_size;
+    unsigned long long generation; // tells thread caches of a reused address apart
+    pthread_mutex_t lock;
+    void* free_list; // linked through the first word of each object
+    size_t free_count;
+    struct slab_chunk_t* chunks;
+    size_t capacity; // objects carved so far
+    struct slab_allocator_t* next_live; // registry of live allocators
+} slab_allocator_t;
+
+// Carves reserve objects up front. Returns -1 on allocation failure.
+int slab_allocator_init(slab_allocator_t* slab, size_t object_size, size_t reserve);
+// Frees every chunk; no object may be used afterwards.
+void slab_allocator_destroy(slab_allocator_t* slab);
+
+// Uninitialized object, NULL when memory runs out.
+void* slab_allocator_alloc(slab_allocator_t* slab);
+void slab_allocator_free(slab_allocator_t* slab, void* object);
+
+// Returns the calling thread's cached objects to the shared list; for
+// threads that exit while the allocator lives on.
+void slab_allocator_release_thread_cache(slab_allocator_t* slab);
+
+// Objects carved so far, cached or not.
+size_t slab_allocator_capacity(slab_allocator_t* slab);
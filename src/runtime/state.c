@@ -3,6 +3,7 @@
 
 #include <errno.h>
 #include <limits.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -10,6 +11,7 @@
 #include <unistd.h>
 
 #include "../../logging.h"
+#include "../../mq_consumer.h"
 
 #ifndef RUNTIME_DEFAULT_WORKERS
 #define RUNTIME_DEFAULT_WORKERS 2
@@ -23,6 +25,67 @@
 #define RUNTIME_DEFAULT_AGING_START 90
 #define RUNTIME_DEFAULT_AGING_STEP 30
 
+#ifndef RUNTIME_HANDOFF_CAPACITY
+#define RUNTIME_HANDOFF_CAPACITY 1024
+#endif
+
+// Records the slab and the waiting heap are sized for at start on top of
+// one per rescuer and whatever the message queues can hold.
+#ifndef RUNTIME_RECORD_RESERVE
+#define RUNTIME_RECORD_RESERVE RUNTIME_HANDOFF_CAPACITY
+#endif
+
+// Backlog the start-up memory report projects the record footprint for.
+#ifndef RUNTIME_MEMORY_BACKLOG
+#define RUNTIME_MEMORY_BACKLOG 1000000
+#endif
+
+#define RUNTIME_SPLICE_CHUNK 64
+
+#define RUNTIME_NOT_ACTIVE ((size_t)-1)
+
+// priority_score = effective priority * RUNTIME_PRIORITY_BAND - min_distance;
+// RUNTIME_NO_UNIT_DISTANCE stands for "no dispatchable unit of a needed type".
+#define RUNTIME_PRIORITY_BAND 100000
+#define RUNTIME_NO_UNIT_DISTANCE 1000000
+
+// Changed units a waiting record compares itself with before it is cheaper
+// to measure it again through the grid.
+#ifndef RUNTIME_RESCORE_SCAN
+#define RUNTIME_RESCORE_SCAN 64
+#endif
+
+// Most emergencies a batched dispatch round assigns.
+#ifndef RUNTIME_BATCH_MAX
+#define RUNTIME_BATCH_MAX 64
+#endif
+
+// Pool controller: ticks are RUNTIME_SCALE_INTERVAL seconds apart. A tick
+// is under pressure when the backlog exceeds RUNTIME_SCALE_BACKLOG per
+// running worker or the p90 queue wait reaches RUNTIME_SCALE_WAIT_P90
+// seconds; the up and down conditions must hold for consecutive ticks.
+#define RUNTIME_SCALE_INTERVAL 1
+#ifndef RUNTIME_SCALE_UP_TICKS
+#define RUNTIME_SCALE_UP_TICKS 2
+#endif
+#ifndef RUNTIME_SCALE_DOWN_TICKS
+#define RUNTIME_SCALE_DOWN_TICKS 10
+#endif
+#ifndef RUNTIME_SCALE_BACKLOG
+#define RUNTIME_SCALE_BACKLOG 4
+#endif
+#ifndef RUNTIME_SCALE_WAIT_P90
+#define RUNTIME_SCALE_WAIT_P90 2
+#endif
+
+enum {
+    RUNTIME_TIMER_DEADLINE = 0,
+    RUNTIME_TIMER_AGING,
+    RUNTIME_TIMER_PHASE,
+    RUNTIME_TIMER_RETURN,
+    RUNTIME_TIMER_SCALE
+};
+
 static unsigned int get_priority_timeout_seconds(const runtime_state_t* state, short priority) {
     if (!state) {
         return 0;
@@ -40,11 +103,20 @@ static short emergency_effective_priority(const emergency_record_t* record) {
         return 0;
     }
 
-    if (record->emergency.dynamic_priority < 0) {
-        return record->emergency.type.priority;
+    if (record->dynamic_priority < 0) {
+        return record->descriptor->type->priority;
     }
 
-    return record->emergency.dynamic_priority;
+    return record->dynamic_priority;
+}
+
+// Slot of a priority in the per-level tables; out-of-range priorities go
+// to the nearest level.
+static size_t runtime_priority_level(short priority) {
+    if (priority < 0) {
+        return 0;
+    }
+    return priority >= (short)RUNTIME_PRIORITY_LEVELS ? RUNTIME_PRIORITY_LEVELS - 1 : (size_t)priority;
 }
 
 static void emergency_timer_start(const runtime_state_t* state, emergency_record_t* record) {
@@ -52,14 +124,13 @@ static void emergency_timer_start(const runtime_state_t* state, emergency_record
         return;
     }
 
-    time_t now = time(NULL);
-    record->emergency.timer_started_at = now;
-    record->emergency.elapsed_timer_seconds = 0;
+    time_t now = runtime_state_now(state);
+    record->timer_started_at = now;
     unsigned int timeout = get_priority_timeout_seconds(state, emergency_effective_priority(record));
     if (timeout > 0 && now != (time_t)-1) {
-        record->emergency.deadline = now + (time_t)timeout;
+        record->deadline = now + (time_t)timeout;
     } else {
-        record->emergency.deadline = 0;
+        record->deadline = 0;
     }
 }
 
@@ -68,9 +139,8 @@ static void emergency_timer_stop(emergency_record_t* record) {
         return;
     }
 
-    record->emergency.timer_started_at = 0;
-    record->emergency.deadline = 0;
-    record->emergency.elapsed_timer_seconds = 0;
+    record->timer_started_at = 0;
+    record->deadline = 0;
 }
 
 static void emergency_record_cleanup(emergency_record_t* record) {
@@ -78,29 +148,29 @@ static void emergency_record_cleanup(emergency_record_t* record) {
         return;
     }
 
-    free(record->assigned_indices);
-    record->assigned_indices = NULL;
-    record->assigned_count = 0;
-
-    free(record->emergency.rescuers_dt);
-    record->emergency.rescuers_dt = NULL;
-    record->emergency.rescuer_count = 0;
+    timer_wheel_cancel(&record->deadline_timer);
+    timer_wheel_cancel(&record->aging_timer);
+    timer_wheel_cancel(&record->phase_timer);
 
+    record->assigned_count = 0;
     record->manage_time_total = 0;
     record->manage_time_remaining = 0;
-    record->preempted = false;
-    record->emergency.timer_started_at = 0;
-    record->emergency.deadline = 0;
-    record->emergency.elapsed_timer_seconds = 0;
+    record->timer_started_at = 0;
+    record->deadline = 0;
 }
 
-static void emergency_record_destroy(emergency_record_t* record) {
+static void emergency_record_destroy(runtime_state_t* state, emergency_record_t* record) {
     if (!record) {
         return;
     }
 
     emergency_record_cleanup(record);
-    free(record);
+    slab_allocator_free(&state->record_slab, record);
+}
+
+// A record's slab object: the record and its inline unit indices.
+static size_t record_object_size(size_t units) {
+    return offsetof(emergency_record_t, assigned_indices) + units * sizeof(int);
 }
 
 static void runtime_state_clear_arrays(runtime_state_t* state) {
@@ -108,17 +178,25 @@ static void runtime_state_clear_arrays(runtime_state_t* state) {
         return;
     }
 
-    for (size_t i = 0; i < state->waiting_count; ++i) {
-        emergency_record_destroy(state->waiting_queue[i]);
+    void* pending[RUNTIME_SPLICE_CHUNK];
+    size_t popped;
+    while ((popped = handoff_ring_pop_bulk(&state->ingest_ring, pending, RUNTIME_SPLICE_CHUNK)) > 0) {
+        for (size_t i = 0; i < popped; ++i) {
+            emergency_record_destroy(state, (emergency_record_t*)pending[i]);
+        }
     }
-    free(state->waiting_queue);
-    state->waiting_queue = NULL;
-    state->waiting_count = 0;
-    state->waiting_capacity = 0;
 
+    // Records waiting with units they kept are on both; the queue frees them.
     for (size_t i = 0; i < state->active_count; ++i) {
-        emergency_record_destroy(state->active_emergencies[i]);
+        if (state->active_emergencies[i]->heap_index == WAITING_HEAP_NOT_QUEUED) {
+            emergency_record_destroy(state, state->active_emergencies[i]);
+        }
     }
+    while (waiting_heap_count(&state->waiting) > 0) {
+        emergency_record_destroy(state, waiting_heap_pop(&state->waiting));
+    }
+    waiting_heap_destroy(&state->waiting);
+
     free(state->active_emergencies);
     state->active_emergencies = NULL;
     state->active_count = 0;
@@ -153,22 +231,6 @@ static int ensure_capacity(emergency_record_t*** array,
     return 0;
 }
 
-static const emergency_type_t* find_emergency_type(const emergency_type_t* types,
-                                                   size_t type_count,
-                                                   const char* name) {
-    if (!types || !name) {
-        return NULL;
-    }
-
-    for (size_t i = 0; i < type_count; ++i) {
-        if (types[i].emergency_name && strcmp(types[i].emergency_name, name) == 0) {
-            return &types[i];
-        }
-    }
-
-    return NULL;
-}
-
 static int compute_manhattan_distance(const rescuer_digital_twin_t* rescuer, int x, int y) {
     if (!rescuer) {
         return INT_MAX;
@@ -186,369 +248,1109 @@ static int compute_manhattan_distance(const rescuer_digital_twin_t* rescuer, int
     return dx + dy;
 }
 
-static int compute_min_distance(const runtime_state_t* state, int x, int y) {
-    if (!state || !state->rescuer_pool || state->rescuer_count == 0) {
-        return INT_MAX;
-    }
+// Scores sort by effective priority first: the distance term is capped
+// below one priority band, so a record no unit can reach yet still ranks
+// above every record of a lower priority.
+static void record_rescore(emergency_record_t* record) {
+    int distance = record->min_distance < RUNTIME_PRIORITY_BAND ? record->min_distance : RUNTIME_PRIORITY_BAND - 1;
+    record->priority_score = emergency_effective_priority(record) * RUNTIME_PRIORITY_BAND - distance;
+}
 
-    int min_distance = INT_MAX;
-    for (size_t i = 0; i < state->rescuer_count; ++i) {
-        const rescuer_digital_twin_t* rescuer = &state->rescuer_pool[i];
-        int distance = compute_manhattan_distance(rescuer, x, y);
-        if (distance < min_distance) {
-            min_distance = distance;
+// Measures the record against the nearest dispatchable unit of each type
+// it needs, through the grid, and files it again if it is waiting. Needs
+// mutex and the record's type locks.
+static void record_measure_locked(runtime_state_t* state, emergency_record_t* record, time_t now) {
+    const emergency_type_descriptor_t* descriptor = record->descriptor;
+    long long best = LLONG_MAX;
+    int best_unit = -1;
+    for (size_t t = 0; t < state->type_lock_count; ++t) {
+        if (descriptor->demand[t] <= 0) {
+            continue;
+        }
+        int unit = rescuer_grid_nearest(&state->available_grid,
+                                        (int)t,
+                                        state->rescuer_pool,
+                                        record->x,
+                                        record->y,
+                                        now);
+        if (unit < 0) {
+            continue;
+        }
+        long long score =
+            rescuer_grid_score(&state->rescuer_pool[unit], record->x, record->y, now);
+        if (score < best) {
+            best = score;
+            best_unit = unit;
         }
     }
 
-    return min_distance;
+    record->nearest_unit = best_unit;
+    record->distance_stale = false;
+    record->min_distance = best_unit >= 0 && best < RUNTIME_NO_UNIT_DISTANCE ? (int)best : RUNTIME_NO_UNIT_DISTANCE;
+    if (record->nearest_list != WAITING_INDEX_NONE) {
+        waiting_index_file(&state->waiting_index, record);
+    }
 }
 
+// Needs mutex and the record's type locks.
 static void update_record_priority_locked(runtime_state_t* state, emergency_record_t* record) {
     if (!state || !record) {
         return;
     }
 
-    record->min_distance = compute_min_distance(state, record->emergency.x, record->emergency.y);
-    if (record->min_distance == INT_MAX) {
-        record->min_distance = 1000000;
+    record_measure_locked(state, record, runtime_state_now(state));
+    record_rescore(record);
+}
+
+// Files a unit whose status or position changed for the next rescore of
+// the waiting records. Needs the unit's type lock.
+static void rescore_note_unit_locked(runtime_state_t* state, int index) {
+    int type_id = state->rescuer_type_ids[index];
+    if (type_id < 0 || state->rescore_flag[index]) {
+        return;
+    }
+
+    state->rescore_flag[index] = 1;
+    state->rescore_units[state->rescore_start[type_id] + state->rescore_count[type_id]++] = index;
+    atomic_fetch_add_explicit(&state->rescore_pending, 1, memory_order_relaxed);
+}
+
+// Wakes the monitor if the new expiry is earlier than the one it sleeps until.
+static void runtime_timer_schedule_locked(runtime_state_t* state, timer_wheel_entry_t* entry, time_t expires) {
+    timer_wheel_schedule(&state->timers, entry, expires);
+    if (state->monitor_wake_at == 0 || expires < state->monitor_wake_at) {
+        pthread_cond_signal(&state->timer_cond);
+    }
+}
+
+// A waiting record times out at its deadline; a low-priority one also ages
+// aging_start seconds after its timer started.
+static void waiting_timers_arm_locked(runtime_state_t* state, emergency_record_t* record) {
+    if (record->timer_started_at != 0 && record->deadline != 0) {
+        runtime_timer_schedule_locked(state, &record->deadline_timer, record->deadline);
+    } else {
+        timer_wheel_cancel(&record->deadline_timer);
+    }
+
+    if (record->descriptor->type->priority == 0 &&
+        emergency_effective_priority(record) < RUNTIME_AGING_MAX_PRIORITY &&
+        record->timer_started_at != 0) {
+        runtime_timer_schedule_locked(state,
+                                      &record->aging_timer,
+                                      record->timer_started_at + (time_t)state->aging_start_seconds);
+    } else {
+        timer_wheel_cancel(&record->aging_timer);
     }
+}
 
-    int priority = emergency_effective_priority(record);
-    record->priority_score = priority * 100000 - record->min_distance;
+static void waiting_timers_cancel(emergency_record_t* record) {
+    timer_wheel_cancel(&record->deadline_timer);
+    timer_wheel_cancel(&record->aging_timer);
 }
 
+static void victim_index_add_locked(runtime_state_t* state, emergency_record_t* record);
+static void victim_index_remove_locked(runtime_state_t* state, emergency_record_t* record);
+
+// A record that kept units through a partial preemption stays active while
+// it waits, and can be preempted again.
 static void waiting_queue_insert_locked(runtime_state_t* state, emergency_record_t* record) {
     if (!state || !record) {
         return;
     }
 
-    if (ensure_capacity(&state->waiting_queue,
-                        &state->waiting_capacity,
-                        state->waiting_count,
-                        1) != 0) {
-        LOG_EMERGENCY_STATUS("RT-QUEUE-ERR", "Unable to grow waiting queue for emergency '%s'", record->emergency.name);
-        emergency_record_destroy(record);
+    if (waiting_heap_push(&state->waiting, record) != 0) {
+        LOG_EMERGENCY_STATUS("RT-QUEUE-ERR", "Unable to grow waiting queue for emergency '%s'", emergency_record_name(record));
+        // One still holding units stays on the active list, which owns it.
+        if (record->active_index == RUNTIME_NOT_ACTIVE) {
+            emergency_record_destroy(state, record);
+        }
         return;
     }
 
-    size_t idx = state->waiting_count;
-    while (idx > 0) {
-        emergency_record_t* prev = state->waiting_queue[idx - 1];
-        if (!prev || prev->priority_score >= record->priority_score) {
-            break;
-        }
-        state->waiting_queue[idx] = state->waiting_queue[idx - 1];
-        --idx;
+    waiting_index_file(&state->waiting_index, record);
+    if (record->active_index != RUNTIME_NOT_ACTIVE) {
+        victim_index_add_locked(state, record);
     }
-
-    state->waiting_queue[idx] = record;
-    state->waiting_count++;
+    waiting_timers_arm_locked(state, record);
 }
 
+// The record leaves the preemption index too, so the units it kept stay
+// put while a worker allocates the rest.
 static emergency_record_t* waiting_queue_pop_front_locked(runtime_state_t* state) {
-    if (!state || state->waiting_count == 0) {
+    if (!state) {
         return NULL;
     }
 
-    emergency_record_t* record = state->waiting_queue[0];
-    if (state->waiting_count > 1) {
-        memmove(&state->waiting_queue[0],
-                &state->waiting_queue[1],
-                (state->waiting_count - 1) * sizeof(emergency_record_t*));
+    emergency_record_t* record = waiting_heap_pop(&state->waiting);
+    if (record) {
+        waiting_timers_cancel(record);
+        waiting_index_remove(&state->waiting_index, record);
+        victim_index_remove_locked(state, record);
     }
-    state->waiting_count--;
-
     return record;
 }
 
-static emergency_record_t* waiting_queue_remove_index_locked(runtime_state_t* state, size_t index) {
-    if (!state || index >= state->waiting_count) {
-        return NULL;
+// Type locks are taken in ascending type ID, after mutex when both are
+// needed. A record's units are exactly the types its descriptor demands.
+static void runtime_lock_types(runtime_state_t* state, const emergency_type_descriptor_t* descriptor) {
+    if (!descriptor) {
+        return;
     }
-
-    emergency_record_t* record = state->waiting_queue[index];
-    if (index + 1 < state->waiting_count) {
-        memmove(&state->waiting_queue[index],
-                &state->waiting_queue[index + 1],
-                (state->waiting_count - index - 1) * sizeof(emergency_record_t*));
+    for (size_t t = 0; t < state->type_lock_count; ++t) {
+        if (descriptor->demand[t] > 0) {
+            pthread_mutex_lock(&state->type_locks[t]);
+        }
     }
-    state->waiting_count--;
-    return record;
 }
 
-static void monitor_returning_rescuers_locked(runtime_state_t* state, time_t now) {
-    if (!state || !state->rescuer_pool) {
+static void runtime_unlock_types(runtime_state_t* state, const emergency_type_descriptor_t* descriptor) {
+    if (!descriptor) {
         return;
     }
-
-    for (size_t i = 0; i < state->rescuer_count; ++i) {
-        rescuer_digital_twin_t* rescuer = &state->rescuer_pool[i];
-        if (rescuer->status != RETURNING_TO_BASE) {
-            continue;
-        }
-        if (rescuer->return_available_at == 0 || now == (time_t)-1) {
-            if (rescuer->type) {
-                update_rescuer_position_locked(state, (int)i, rescuer->type->x, rescuer->type->y);
-            }
-            update_rescuer_status_locked(state, (int)i, IDLE, NULL);
-            pthread_cond_broadcast(&state->rescuer_available_cond);
-            continue;
-        }
-        if (now < rescuer->return_available_at) {
-            continue;
-        }
-        if (rescuer->type) {
-            update_rescuer_position_locked(state, (int)i, rescuer->type->x, rescuer->type->y);
+    for (size_t t = state->type_lock_count; t > 0; --t) {
+        if (descriptor->demand[t - 1] > 0) {
+            pthread_mutex_unlock(&state->type_locks[t - 1]);
         }
-        update_rescuer_status_locked(state, (int)i, IDLE, NULL);
-        pthread_cond_broadcast(&state->rescuer_available_cond);
     }
 }
 
-static void monitor_waiting_queue_locked(runtime_state_t* state, time_t now) {
-    if (!state) {
-        return;
+static void runtime_lock_all_types(runtime_state_t* state) {
+    for (size_t t = 0; t < state->type_lock_count; ++t) {
+        pthread_mutex_lock(&state->type_locks[t]);
     }
+}
 
-    size_t idx = 0;
-    while (idx < state->waiting_count) {
-        emergency_record_t* record = state->waiting_queue[idx];
-        if (!record) {
-            ++idx;
-            continue;
-        }
+static void runtime_unlock_all_types(runtime_state_t* state) {
+    for (size_t t = state->type_lock_count; t > 0; --t) {
+        pthread_mutex_unlock(&state->type_locks[t - 1]);
+    }
+}
 
-        if (record->emergency.timer_started_at != 0 && record->emergency.deadline != 0 &&
-            now != (time_t)-1 && now >= record->emergency.deadline) {
-            record->emergency.elapsed_timer_seconds =
-                (unsigned int)(now - record->emergency.timer_started_at);
-            emergency_status_t prev = record->emergency.status;
-            record->emergency.status = TIMEOUT;
-            LOG_EMERGENCY_STATUS("RT-TIMEOUT",
-                                 "Emergency '%s' %s -> %s after waiting %u seconds",
-                                 record->emergency.name,
-                                 prev == WAITING ? "WAITING" : prev == PAUSED ? "PAUSED" : "UNKNOWN",
-                                 "TIMEOUT",
-                                 record->emergency.elapsed_timer_seconds);
-            waiting_queue_remove_index_locked(state, idx);
-            pthread_cond_broadcast(&state->progress_cond);
-            emergency_record_destroy(record);
-            continue;
+// Measures stale records again until the one at the head of the waiting
+// queue is up to date. Needs mutex and every type lock.
+static emergency_record_t* runtime_waiting_head_locked(runtime_state_t* state, time_t now) {
+    emergency_record_t* record = waiting_heap_peek(&state->waiting);
+    while (record && record->distance_stale) {
+        record_measure_locked(state, record, now);
+        record_rescore(record);
+        waiting_heap_update(&state->waiting, record);
+        record = waiting_heap_peek(&state->waiting);
+    }
+    return record;
+}
+
+typedef struct rescore_reach_t {
+    runtime_state_t* state;
+    int unit;
+} rescore_reach_t;
+
+// A filed unit beats the nearest one of a waiting record it reaches:
+// the record is measured to it from now on.
+static void rescore_reach_visit(emergency_record_t* record, long long score, void* arg) {
+    rescore_reach_t* reach = arg;
+    record->min_distance = (int)score;
+    record->nearest_unit = reach->unit;
+    record->distance_stale = false;
+    waiting_index_file(&reach->state->waiting_index, record);
+    record_rescore(record);
+    waiting_heap_update(&reach->state->waiting, record);
+}
+
+// Brings the waiting records' priority_score up to date with the units
+// filed since the last pass, visiting only the records those units can
+// change, through the waiting index:
+// - a record whose own nearest unit was filed keeps its score if the unit
+//   is as close as before; if the unit was claimed or moved away the
+//   record can only get further, so it keeps its score and is marked
+//   stale: its score stays an upper bound and it is measured again only
+//   once it reaches the head of the queue;
+// - a record no unit could reach is measured again once a unit of a type
+//   it needs can be dispatched (compared with the filed units, or through
+//   the grid when there are more than RUNTIME_RESCORE_SCAN of them);
+// - a filed unit that can be dispatched visits the cells of the records
+//   needing its type where it may beat their nearest unit.
+// Each changed record is moved within the heap on its own. Called with
+// mutex held.
+static void runtime_rescore_waiting_locked(runtime_state_t* state) {
+    if (atomic_load_explicit(&state->rescore_pending, memory_order_relaxed) == 0) {
+        emergency_record_t* head = waiting_heap_peek(&state->waiting);
+        if (!head || !head->distance_stale) {
+            return;
         }
+    }
 
-        short base_priority = record->emergency.type.priority;
-        short effective_priority = emergency_effective_priority(record);
-        if (base_priority == 0 && effective_priority < RUNTIME_AGING_MAX_PRIORITY) {
-            if (record->emergency.timer_started_at == 0) {
-                emergency_timer_start(state, record);
+    runtime_lock_all_types(state);
+    time_t now = runtime_state_now(state);
+    size_t type_count = state->type_lock_count;
+    waiting_index_t* index = &state->waiting_index;
+
+    // Keep only the filed units that can be dispatched now, per type.
+    size_t kept_total = 0;
+    for (size_t t = 0; t < type_count; ++t) {
+        int* units = &state->rescore_units[state->rescore_start[t]];
+        size_t kept = 0;
+        for (size_t k = 0; k < state->rescore_count[t]; ++k) {
+            if (rescuer_grid_contains(&state->available_grid, units[k])) {
+                int unit = units[k];
+                units[k] = units[kept];
+                units[kept++] = unit;
             }
-            if (record->emergency.timer_started_at != 0 && now != (time_t)-1) {
-                time_t waited = now - record->emergency.timer_started_at;
-                if (waited >= (time_t)state->aging_start_seconds) {
-                    time_t over = waited - (time_t)state->aging_start_seconds;
-                    unsigned int steps = 1;
-                    if (state->aging_step_seconds > 0 && over > 0) {
-                        steps += (unsigned int)(over / state->aging_step_seconds);
-                    }
-                    if (steps > 0) {
-                        record->emergency.dynamic_priority = RUNTIME_AGING_MAX_PRIORITY;
-                        emergency_timer_start(state, record);
-                        update_record_priority_locked(state, record);
-                        waiting_queue_remove_index_locked(state, idx);
-                        waiting_queue_insert_locked(state, record);
-                        LOG_EMERGENCY_STATUS("RT-AGING",
-                                             "Emergency '%s' aged to priority %d after %ld seconds",
-                                             record->emergency.name,
-                                             record->emergency.dynamic_priority,
-                                             (long)waited);
-                        pthread_cond_signal(&state->emergency_available_cond);
-                        continue;
+        }
+        state->rescore_kept[t] = kept;
+        kept_total += kept;
+    }
+
+    for (size_t t = 0; t < type_count; ++t) {
+        const int* units = &state->rescore_units[state->rescore_start[t]];
+        int base_head = rescuer_grid_base_head(&state->available_grid, (int)t);
+        for (size_t k = 0; k < state->rescore_count[t]; ++k) {
+            int unit = units[k];
+            bool available = k < state->rescore_kept[t];
+            emergency_record_t* next;
+            for (emergency_record_t* record = waiting_index_first(index, unit); record; record = next) {
+                next = record->nearest_next;
+                long long score = LLONG_MAX;
+                if (available) {
+                    score = rescuer_grid_score(&state->rescuer_pool[unit], record->x, record->y, now);
+                }
+                if (score <= record->min_distance) {
+                    if (score < record->min_distance) {
+                        record->min_distance = (int)score;
+                        waiting_index_file(index, record);
+                        record_rescore(record);
+                        waiting_heap_update(&state->waiting, record);
                     }
+                } else if (base_head >= 0 && base_head != unit &&
+                           rescuer_grid_score(&state->rescuer_pool[base_head], record->x, record->y, now) ==
+                               record->min_distance) {
+                    // Units idle at base are interchangeable.
+                    record->nearest_unit = base_head;
+                    waiting_index_file(index, record);
+                } else {
+                    record->distance_stale = true;
                 }
             }
         }
-
-        ++idx;
     }
-}
 
-static size_t active_list_add_locked(runtime_state_t* state, emergency_record_t* record) {
-    if (!state || !record) {
-        return (size_t)-1;
+    emergency_record_t* next;
+    for (emergency_record_t* record = waiting_index_first(index, -1); kept_total > 0 && record; record = next) {
+        next = record->nearest_next;
+        const int* demand = record->descriptor->demand;
+        size_t relevant = 0;
+        for (size_t t = 0; t < type_count; ++t) {
+            relevant += demand[t] > 0 ? state->rescore_kept[t] : 0;
+        }
+        if (relevant == 0) {
+            continue;
+        }
+        if (relevant > RUNTIME_RESCORE_SCAN) {
+            record_measure_locked(state, record, now);
+        } else {
+            for (size_t t = 0; t < type_count; ++t) {
+                if (demand[t] <= 0) {
+                    continue;
+                }
+                const int* units = &state->rescore_units[state->rescore_start[t]];
+                for (size_t k = 0; k < state->rescore_kept[t]; ++k) {
+                    long long score = rescuer_grid_score(&state->rescuer_pool[units[k]],
+                                                         record->x,
+                                                         record->y,
+                                                         now);
+                    if (score < record->min_distance) {
+                        record->min_distance = (int)score;
+                        record->nearest_unit = units[k];
+                    }
+                }
+            }
+            waiting_index_file(index, record);
+        }
+        record_rescore(record);
+        waiting_heap_update(&state->waiting, record);
+    }
+
+    for (size_t t = 0; t < type_count; ++t) {
+        const int* units = &state->rescore_units[state->rescore_start[t]];
+        for (size_t k = 0; k < state->rescore_kept[t]; ++k) {
+            const rescuer_digital_twin_t* rescuer = &state->rescuer_pool[units[k]];
+            rescore_reach_t reach = {state, units[k]};
+            // Scored at its own place, a unit is worth just its wait.
+            waiting_index_reach(index,
+                                (int)t,
+                                rescuer->x,
+                                rescuer->y,
+                                rescuer_grid_score(rescuer, rescuer->x, rescuer->y, now),
+                                rescore_reach_visit,
+                                &reach);
+        }
     }
 
-    if (ensure_capacity(&state->active_emergencies,
-                        &state->active_capacity,
-                        state->active_count,
-                        1) != 0) {
-        LOG_EMERGENCY_STATUS("RT-ACTIVE-ERR", "Unable to track active emergency '%s'", record->emergency.name);
-        emergency_record_destroy(record);
-        return (size_t)-1;
+    for (size_t t = 0; t < type_count; ++t) {
+        const int* units = &state->rescore_units[state->rescore_start[t]];
+        for (size_t k = 0; k < state->rescore_count[t]; ++k) {
+            state->rescore_flag[units[k]] = 0;
+        }
+        state->rescore_count[t] = 0;
     }
+    atomic_store_explicit(&state->rescore_pending, 0, memory_order_relaxed);
 
-    state->active_emergencies[state->active_count] = record;
-    size_t index = state->active_count;
-    state->active_count++;
-    return index;
+    runtime_waiting_head_locked(state, now);
+    runtime_unlock_all_types(state);
 }
 
-static emergency_record_t* active_list_remove_index_locked(runtime_state_t* state, size_t index) {
-    if (!state || index >= state->active_count) {
-        return NULL;
+// Takes worker out of every rescuer wait channel.
+static void rescuer_wait_unlist_locked(runtime_state_t* state, runtime_worker_t* worker) {
+    if (!worker->waiting_rescuers) {
+        return;
     }
+    for (size_t t = 0; t < state->type_index->rescuer_type_count; ++t) {
+        state->rescuer_waiters[t * state->worker_capacity + worker->id] = 0;
+    }
+    worker->waiting_rescuers = false;
+    --state->rescuer_wait_count;
+}
 
-    emergency_record_t* removed = state->active_emergencies[index];
-    if (index + 1 < state->active_count) {
-        memmove(&state->active_emergencies[index],
-                &state->active_emergencies[index + 1],
-                (state->active_count - index - 1) * sizeof(emergency_record_t*));
+static void worker_unpark_locked(runtime_state_t* state, runtime_worker_t* worker) {
+    if (worker->idle) {
+        for (size_t i = 0; i < state->idle_count; ++i) {
+            if (state->idle_workers[i] == worker->id) {
+                memmove(&state->idle_workers[i],
+                        &state->idle_workers[i + 1],
+                        (state->idle_count - i - 1) * sizeof(size_t));
+                --state->idle_count;
+                break;
+            }
+        }
+        worker->idle = false;
     }
-    state->active_count--;
-    return removed;
+    rescuer_wait_unlist_locked(state, worker);
+    pthread_cond_signal(&worker->wake);
 }
 
-static ssize_t active_list_find_index_locked(runtime_state_t* state, const emergency_record_t* record) {
-    if (!state || !record) {
-        return -1;
+// Wakes up to count idle workers, the most recently parked first since its
+// cache is the warmest. Without running workers (settle) this is a no-op.
+static void wake_workers_locked(runtime_state_t* state, size_t count) {
+    while (count-- > 0 && state->idle_count > 0) {
+        runtime_worker_t* worker = &state->workers[state->idle_workers[--state->idle_count]];
+        worker->idle = false;
+        pthread_cond_signal(&worker->wake);
     }
+}
 
-    for (size_t i = 0; i < state->active_count; ++i) {
-        if (state->active_emergencies[i] == record) {
-            return (ssize_t)i;
+static int record_missing_units(const runtime_state_t* state, const emergency_record_t* record, size_t type_id);
+
+// Whether the head of the queue could be served now: every type it is
+// short of is covered by dispatchable units, or by units lower-priority
+// emergencies hold, as far as preemption_plan_locked() counts them.
+static bool rescuer_head_ready_locked(runtime_state_t* state, const emergency_record_t* head) {
+    size_t type_count = state->type_index->rescuer_type_count;
+    size_t level = runtime_priority_level(emergency_effective_priority(head));
+    for (size_t t = 0; t < type_count; ++t) {
+        int missing = record_missing_units(state, head, t);
+        if (missing <= 0) {
+            continue;
+        }
+        pthread_mutex_lock(&state->type_locks[t]);
+        long long need = missing - (long long)rescuer_grid_count(&state->available_grid, (int)t);
+        pthread_mutex_unlock(&state->type_locks[t]);
+        for (size_t below = 0; below < level && need > 0; ++below) {
+            need -= (long long)state->victim_units[below * type_count + t];
+        }
+        if (need > 0) {
+            return false;
         }
     }
-
-    return -1;
+    return true;
 }
 
-static unsigned int compute_travel_time_seconds(const rescuer_digital_twin_t* rescuer,
-                                                int target_x,
-                                                int target_y) {
-    if (!rescuer) {
-        return 1;
+// After record let go of its units: wakes one worker listed under the type
+// of one of them, if the head of the queue, which is all a woken worker
+// would try, can now be served. Waking more would only race it for the
+// same head.
+static void wake_record_waiters_locked(runtime_state_t* state, const emergency_record_t* record) {
+    if (state->rescuer_wait_count == 0) {
+        return;
     }
 
-    int distance = compute_manhattan_distance(rescuer, target_x, target_y);
-    int speed = 1;
-    if (rescuer->type && rescuer->type->speed > 0) {
-        speed = rescuer->type->speed;
+    runtime_worker_t* waiter = NULL;
+    for (size_t i = 0; i < record->assigned_count && !waiter; ++i) {
+        int type_id = state->rescuer_type_ids[record->assigned_indices[i]];
+        if (type_id < 0) {
+            continue;
+        }
+        const unsigned char* channel = &state->rescuer_waiters[(size_t)type_id * state->worker_capacity];
+        for (size_t w = 0; w < state->worker_count; ++w) {
+            if (channel[w]) {
+                waiter = &state->workers[w];
+                break;
+            }
+        }
     }
-
-    int time_needed = distance / speed;
-    if (distance % speed != 0) {
-        ++time_needed;
+    const emergency_record_t* head = waiting_heap_peek(&state->waiting);
+    if (!waiter || !head || !rescuer_head_ready_locked(state, head)) {
+        return;
     }
+    waiter->units_woken = true;
+    worker_unpark_locked(state, waiter);
+}
 
-    if (time_needed <= 0) {
-        time_needed = 1;
+// Keys the wait of the workers parked for units on head: lists each of
+// them under every type head is short of in dispatchable units. Returns
+// false when it is short of none.
+static bool rescuer_wait_key_locked(runtime_state_t* state, const emergency_record_t* head) {
+    bool short_of_any = false;
+    for (size_t t = 0; t < state->type_index->rescuer_type_count; ++t) {
+        int missing = record_missing_units(state, head, t);
+        bool short_of = false;
+        if (missing > 0) {
+            pthread_mutex_lock(&state->type_locks[t]);
+            short_of = rescuer_grid_count(&state->available_grid, (int)t) < (size_t)missing;
+            pthread_mutex_unlock(&state->type_locks[t]);
+        }
+        unsigned char* channel = &state->rescuer_waiters[t * state->worker_capacity];
+        for (size_t w = 0; w < state->worker_count; ++w) {
+            channel[w] = short_of && state->workers[w].waiting_rescuers;
+        }
+        short_of_any = short_of_any || short_of;
     }
-
-    return (unsigned int)time_needed;
+    state->rescuer_wait_head = head;
+    state->rescuer_wait_sequence = head->heap_sequence;
+    return short_of_any;
 }
 
-static unsigned int compute_management_time_seconds(const emergency_record_t* record) {
-    if (!record || !record->emergency.type.rescuer_requests || record->emergency.type.rescuers_req_number == 0) {
-        return 1;
+// Run after the head of the queue may have changed without any unit being
+// freed (arrivals, deadlines, aging). The workers parked for units are
+// keyed on the new head without waking them; one is woken only if that
+// head can be served, and with the queue empty they park as idle.
+static void rekey_rescuer_waiters_locked(runtime_state_t* state) {
+    if (state->rescuer_wait_count == 0) {
+        return;
+    }
+    const emergency_record_t* head = waiting_heap_peek(&state->waiting);
+    if (head == state->rescuer_wait_head && (!head || head->heap_sequence == state->rescuer_wait_sequence)) {
+        return;
     }
 
-    unsigned int max_time = 1;
-    for (int i = 0; i < record->emergency.type.rescuers_req_number; ++i) {
-        const rescuer_request_t* req = &record->emergency.type.rescuer_requests[i];
-        if (req->time_to_manage > (int)max_time) {
-            max_time = (unsigned int)req->time_to_manage;
+    if (!head) {
+        state->rescuer_wait_head = NULL;
+        for (size_t i = 0; i < state->worker_count; ++i) {
+            runtime_worker_t* worker = &state->workers[i];
+            if (worker->waiting_rescuers) {
+                rescuer_wait_unlist_locked(state, worker);
+                worker->idle = true;
+                state->idle_workers[state->idle_count++] = worker->id;
+            }
         }
+        return;
     }
-
-    if (max_time == 0) {
-        max_time = 1;
+    if (rescuer_wait_key_locked(state, head) && !rescuer_head_ready_locked(state, head)) {
+        return;
+    }
+    for (size_t i = 0; i < state->worker_count; ++i) {
+        if (state->workers[i].waiting_rescuers) {
+            state->workers[i].units_woken = true;
+            worker_unpark_locked(state, &state->workers[i]);
+            return;
+        }
     }
-
-    return max_time;
 }
 
+static void rescuer_set_status_locked(runtime_state_t* state,
+                                      int index,
+                                      rescuer_status_t new_status,
+                                      const char* emergency_name);
+
 static void update_rescuer_status_locked(runtime_state_t* state,
                                          int index,
                                          rescuer_status_t new_status,
                                          const char* emergency_name);
 
 static void update_rescuer_position_locked(runtime_state_t* state, int index, int x, int y);
+static void send_units_home_locked(runtime_state_t* state, emergency_record_t* record, time_t now);
+static void active_list_remove_locked(runtime_state_t* state, emergency_record_t* record);
 
-static void log_rescuer_transition(const rescuer_digital_twin_t* rescuer,
-                                   rescuer_status_t old_status,
-                                   rescuer_status_t new_status,
-                                   const char* emergency_name) {
-    if (!rescuer) {
-        return;
+// A unit claimed by a dispatch since the timer was armed is no longer
+// RETURNING_TO_BASE and is left alone. No waiter is woken: the unit could
+// be dispatched all along its way back.
+static void on_rescuer_returned_locked(runtime_state_t* state, size_t index) {
+    rescuer_digital_twin_t* rescuer = &state->rescuer_pool[index];
+    int type_id = state->rescuer_type_ids[index];
+    if (type_id >= 0) {
+        pthread_mutex_lock(&state->type_locks[type_id]);
+    }
+    bool returned = rescuer->status == RETURNING_TO_BASE;
+    if (returned) {
+        if (rescuer->type) {
+            update_rescuer_position_locked(state, (int)index, rescuer->type->x, rescuer->type->y);
+        }
+        update_rescuer_status_locked(state, (int)index, IDLE, NULL);
+    }
+    if (type_id >= 0) {
+        pthread_mutex_unlock(&state->type_locks[type_id]);
     }
+}
 
-    const char* rescuer_type_name = rescuer->type ? rescuer->type->rescuer_type_name : "unknown";
-    LOG_RESCUER_STATUS("RESC-STATE",
-                       "Rescuer %d (%s) %s -> %s for emergency '%s'",
-                       rescuer->id,
-                       rescuer_type_name,
-                       old_status == IDLE ? "IDLE" :
-                       old_status == EN_ROUTE_TO_SCENE ? "EN_ROUTE_TO_SCENE" :
-                       old_status == ON_SCENE ? "ON_SCENE" :
-                       old_status == RETURNING_TO_BASE ? "RETURNING_TO_BASE" : "UNKNOWN",
-                       new_status == IDLE ? "IDLE" :
-                       new_status == EN_ROUTE_TO_SCENE ? "EN_ROUTE_TO_SCENE" :
-                       new_status == ON_SCENE ? "ON_SCENE" :
-                       new_status == RETURNING_TO_BASE ? "RETURNING_TO_BASE" : "UNKNOWN",
-                       emergency_name ? emergency_name : "");
+static void on_waiting_deadline_locked(runtime_state_t* state, emergency_record_t* record, time_t now) {
+    unsigned int waited = (unsigned int)(now - record->timer_started_at);
+    emergency_status_t prev = record->status;
+    record->status = TIMEOUT;
+    LOG_EMERGENCY_STATUS("RT-TIMEOUT",
+                         "Emergency '%s' %s -> %s after waiting %u seconds",
+                         emergency_record_name(record),
+                         prev == WAITING ? "WAITING" : prev == PAUSED ? "PAUSED" : "UNKNOWN",
+                         "TIMEOUT",
+                         waited);
+    waiting_heap_remove(&state->waiting, record);
+    waiting_index_remove(&state->waiting_index, record);
+    if (record->active_index != RUNTIME_NOT_ACTIVE) {
+        // Units it kept through a partial preemption go home.
+        active_list_remove_locked(state, record);
+        runtime_lock_types(state, record->descriptor);
+        send_units_home_locked(state, record, now);
+        runtime_unlock_types(state, record->descriptor);
+        wake_record_waiters_locked(state, record);
+    }
+    rekey_rescuer_waiters_locked(state);
+    pthread_cond_broadcast(&state->progress_cond);
+    emergency_record_destroy(state, record);
 }
 
-static void* runtime_worker_thread(void* arg);
-static void* runtime_monitor_thread(void* arg);
+static void on_waiting_aging_locked(runtime_state_t* state, emergency_record_t* record, time_t now) {
+    time_t waited = now - record->timer_started_at;
+    victim_index_remove_locked(state, record);
+    record->dynamic_priority = RUNTIME_AGING_MAX_PRIORITY;
+    emergency_timer_start(state, record);
+    runtime_lock_types(state, record->descriptor);
+    update_record_priority_locked(state, record);
+    runtime_unlock_types(state, record->descriptor);
+    waiting_heap_update(&state->waiting, record);
+    if (record->active_index != RUNTIME_NOT_ACTIVE) {
+        victim_index_add_locked(state, record);
+    }
+    waiting_timers_arm_locked(state, record);
+    rekey_rescuer_waiters_locked(state);
+    LOG_EMERGENCY_STATUS("RT-AGING",
+                         "Emergency '%s' aged to priority %d after %ld seconds",
+                         emergency_record_name(record),
+                         record->dynamic_priority,
+                         (long)waited);
+    wake_workers_locked(state, 1);
+}
 
-int runtime_state_init(runtime_state_t* state,
-                       const rescuer_digital_twin_t* rescuers,
-                       size_t rescuer_count,
-                       const environment_variable_t* environment) {
-    if (!state) {
-        return -1;
-    }
+static void on_emergency_phase_locked(runtime_state_t* state, emergency_record_t* record, time_t now);
 
-    memset(state, 0, sizeof(*state));
+static void runtime_scale_workers_locked(runtime_state_t* state, time_t now);
 
-    if (pthread_mutex_init(&state->mutex, NULL) != 0) {
-        return -1;
+static void runtime_timer_fired_locked(runtime_state_t* state, timer_wheel_entry_t* entry, time_t now) {
+    switch (entry->kind) {
+        case RUNTIME_TIMER_DEADLINE:
+            on_waiting_deadline_locked(
+                state,
+                (emergency_record_t*)((char*)entry - offsetof(emergency_record_t, deadline_timer)),
+                now);
+            break;
+        case RUNTIME_TIMER_AGING:
+            on_waiting_aging_locked(
+                state,
+                (emergency_record_t*)((char*)entry - offsetof(emergency_record_t, aging_timer)),
+                now);
+            break;
+        case RUNTIME_TIMER_PHASE:
+            on_emergency_phase_locked(
+                state,
+                (emergency_record_t*)((char*)entry - offsetof(emergency_record_t, phase_timer)),
+                now);
+            break;
+        case RUNTIME_TIMER_RETURN:
+            on_rescuer_returned_locked(state, (size_t)(entry - state->return_timers));
+            break;
+        case RUNTIME_TIMER_SCALE:
+            runtime_scale_workers_locked(state, now);
+            break;
+        default:
+            break;
     }
+}
 
-    if (pthread_cond_init(&state->emergency_available_cond, NULL) != 0) {
-        pthread_mutex_destroy(&state->mutex);
-        return -1;
+// Queues a fired phase or return timer on its owner and wakes the owner if
+// it is parked, otherwise an idle worker that can steal it.
+static void runtime_queue_step_locked(runtime_state_t* state, timer_wheel_entry_t* entry) {
+    size_t owner;
+    if (entry->kind == RUNTIME_TIMER_PHASE) {
+        owner = ((emergency_record_t*)((char*)entry - offsetof(emergency_record_t, phase_timer)))->owner_worker;
+    } else {
+        owner = (size_t)(entry - state->return_timers);
     }
 
-    if (pthread_cond_init(&state->rescuer_available_cond, NULL) != 0) {
-        pthread_cond_destroy(&state->emergency_available_cond);
-        pthread_mutex_destroy(&state->mutex);
-        return -1;
+    runtime_worker_t* worker = &state->workers[owner % state->worker_count];
+    timer_wheel_list_push(&worker->steps, entry);
+    if (worker->idle || worker->waiting_rescuers) {
+        worker_unpark_locked(state, worker);
+    } else {
+        wake_workers_locked(state, 1);
     }
+}
 
-    if (pthread_cond_init(&state->progress_cond, NULL) != 0) {
-        pthread_cond_destroy(&state->rescuer_available_cond);
-        pthread_cond_destroy(&state->emergency_available_cond);
-        pthread_mutex_destroy(&state->mutex);
-        return -1;
+// Handles every timer that expired by now and returns how many fired.
+// Waiting deadlines and aging only touch the queue and run here; with
+// workers running, phase and return timers are handed to them as steps.
+static size_t runtime_fire_timers_locked(runtime_state_t* state, time_t now) {
+    timer_wheel_advance(&state->timers, now);
+
+    size_t fired = 0;
+    timer_wheel_entry_t* entry;
+    while ((entry = timer_wheel_pop_due(&state->timers)) != NULL) {
+        ++fired;
+        if (state->worker_count > 0 &&
+            (entry->kind == RUNTIME_TIMER_PHASE || entry->kind == RUNTIME_TIMER_RETURN)) {
+            runtime_queue_step_locked(state, entry);
+        } else {
+            runtime_timer_fired_locked(state, entry, now);
+        }
     }
+    return fired;
+}
 
-    if (rescuer_count > 0) {
-        state->rescuer_pool = calloc(rescuer_count, sizeof(rescuer_digital_twin_t));
-        if (!state->rescuer_pool) {
-            pthread_cond_destroy(&state->rescuer_available_cond);
-            pthread_cond_destroy(&state->emergency_available_cond);
-            pthread_cond_destroy(&state->progress_cond);
-            pthread_mutex_destroy(&state->mutex);
-            return -1;
+// Adds, per rescuer type, sign for every unit the record holds.
+static void record_count_units(const runtime_state_t* state,
+                               const emergency_record_t* record,
+                               long long* counts,
+                               long long sign) {
+    for (size_t i = 0; i < record->assigned_count; ++i) {
+        int type_id = state->rescuer_type_ids[record->assigned_indices[i]];
+        if (type_id >= 0) {
+            counts[type_id] += sign;
         }
+    }
+}
 
-        memcpy(state->rescuer_pool, rescuers, rescuer_count * sizeof(rescuer_digital_twin_t));
-        for (size_t i = 0; i < rescuer_count; ++i) {
-            state->rescuer_pool[i].status = IDLE;
-            state->rescuer_pool[i].return_available_at = 0;
+// Units of a type the record still has to be given: its demand, less what
+// it kept through a partial preemption.
+static int record_missing_units(const runtime_state_t* state, const emergency_record_t* record, size_t type_id) {
+    if (!record->descriptor) {
+        return 0;
+    }
+
+    int missing = record->descriptor->demand[type_id];
+    for (size_t i = 0; i < record->assigned_count && missing > 0; ++i) {
+        if (state->rescuer_type_ids[record->assigned_indices[i]] == (int)type_id) {
+            --missing;
         }
     }
-    state->rescuer_count = rescuer_count;
+    return missing;
+}
+
+// Units held by an active record are EN_ROUTE_TO_SCENE or ON_SCENE, so they
+// can all be preempted. No-op if the record is already listed.
+static void victim_index_add_locked(runtime_state_t* state, emergency_record_t* record) {
+    const emergency_type_descriptor_t* descriptor = record->descriptor;
+    if (!descriptor || record->victim_level >= 0 || record->assigned_count == 0) {
+        return;
+    }
+
+    size_t level = runtime_priority_level(emergency_effective_priority(record));
+    emergency_record_t** head = &state->victim_lists[level * state->type_index->count + (size_t)descriptor->id];
+    record->victim_level = (short)level;
+    record->victim_prev = NULL;
+    record->victim_next = *head;
+    if (*head) {
+        (*head)->victim_prev = record;
+    }
+    *head = record;
+
+    for (size_t i = 0; i < record->assigned_count; ++i) {
+        int type_id = state->rescuer_type_ids[record->assigned_indices[i]];
+        if (type_id >= 0) {
+            ++state->victim_units[level * state->type_index->rescuer_type_count + (size_t)type_id];
+        }
+    }
+}
+
+// No-op if the record is not listed.
+static void victim_index_remove_locked(runtime_state_t* state, emergency_record_t* record) {
+    if (record->victim_level < 0) {
+        return;
+    }
+
+    size_t level = (size_t)record->victim_level;
+    if (record->victim_prev) {
+        record->victim_prev->victim_next = record->victim_next;
+    } else {
+        state->victim_lists[level * state->type_index->count + (size_t)record->descriptor->id] = record->victim_next;
+    }
+    if (record->victim_next) {
+        record->victim_next->victim_prev = record->victim_prev;
+    }
+    record->victim_prev = NULL;
+    record->victim_next = NULL;
+    record->victim_level = -1;
+
+    for (size_t i = 0; i < record->assigned_count; ++i) {
+        int type_id = state->rescuer_type_ids[record->assigned_indices[i]];
+        if (type_id >= 0) {
+            --state->victim_units[level * state->type_index->rescuer_type_count + (size_t)type_id];
+        }
+    }
+}
+
+// Active records remember their slot, so removal is O(1) and stays correct
+// while other records come and go.
+static int active_list_add_locked(runtime_state_t* state, emergency_record_t* record) {
+    if (!state || !record) {
+        return -1;
+    }
+
+    if (ensure_capacity(&state->active_emergencies,
+                        &state->active_capacity,
+                        state->active_count,
+                        1) != 0) {
+        LOG_EMERGENCY_STATUS("RT-ACTIVE-ERR", "Unable to track active emergency '%s'", emergency_record_name(record));
+        return -1;
+    }
+
+    record->active_index = state->active_count;
+    state->active_emergencies[state->active_count++] = record;
+    victim_index_add_locked(state, record);
+    return 0;
+}
+
+static void active_list_remove_locked(runtime_state_t* state, emergency_record_t* record) {
+    if (!state || !record || record->active_index >= state->active_count ||
+        state->active_emergencies[record->active_index] != record) {
+        return;
+    }
+
+    size_t index = record->active_index;
+    emergency_record_t* last = state->active_emergencies[--state->active_count];
+    state->active_emergencies[index] = last;
+    last->active_index = index;
+    record->active_index = RUNTIME_NOT_ACTIVE;
+    victim_index_remove_locked(state, record);
+}
+
+static unsigned int compute_travel_time_seconds(const rescuer_digital_twin_t* rescuer,
+                                                int target_x,
+                                                int target_y) {
+    if (!rescuer) {
+        return 1;
+    }
+
+    int distance = compute_manhattan_distance(rescuer, target_x, target_y);
+    int speed = 1;
+    if (rescuer->type && rescuer->type->speed > 0) {
+        speed = rescuer->type->speed;
+    }
+
+    int time_needed = distance / speed;
+    if (distance % speed != 0) {
+        ++time_needed;
+    }
+
+    if (time_needed <= 0) {
+        time_needed = 1;
+    }
+
+    return (unsigned int)time_needed;
+}
+
+static void log_rescuer_transition(const rescuer_digital_twin_t* rescuer,
+                                   rescuer_status_t old_status,
+                                   rescuer_status_t new_status,
+                                   const char* emergency_name) {
+    if (!rescuer) {
+        return;
+    }
+
+    const char* rescuer_type_name = rescuer->type ? rescuer->type->rescuer_type_name : "unknown";
+    LOG_RESCUER_STATUS("RESC-STATE",
+                       "Rescuer %d (%s) %s -> %s for emergency '%s'",
+                       rescuer->id,
+                       rescuer_type_name,
+                       old_status == IDLE ? "IDLE" :
+                       old_status == EN_ROUTE_TO_SCENE ? "EN_ROUTE_TO_SCENE" :
+                       old_status == ON_SCENE ? "ON_SCENE" :
+                       old_status == RETURNING_TO_BASE ? "RETURNING_TO_BASE" : "UNKNOWN",
+                       new_status == IDLE ? "IDLE" :
+                       new_status == EN_ROUTE_TO_SCENE ? "EN_ROUTE_TO_SCENE" :
+                       new_status == ON_SCENE ? "ON_SCENE" :
+                       new_status == RETURNING_TO_BASE ? "RETURNING_TO_BASE" : "UNKNOWN",
+                       emergency_name ? emergency_name : "");
+}
+
+// Frees what runtime_fleet_init() set up; safe on a partial setup.
+static void runtime_fleet_destroy(runtime_state_t* state) {
+    rescuer_grid_destroy(&state->available_grid);
+    waiting_index_destroy(&state->waiting_index);
+    for (size_t t = 0; t < state->type_lock_count; ++t) {
+        pthread_mutex_destroy(&state->type_locks[t]);
+    }
+    free(state->type_locks);
+    state->type_locks = NULL;
+    state->type_lock_count = 0;
+    free(state->rescore_units);
+    free(state->rescore_start);
+    free(state->rescore_count);
+    free(state->rescore_kept);
+    free(state->rescore_flag);
+    state->rescore_units = NULL;
+    state->rescore_start = NULL;
+    state->rescore_count = NULL;
+    state->rescore_kept = NULL;
+    state->rescore_flag = NULL;
+    free(state->rescuer_type_ids);
+    state->rescuer_type_ids = NULL;
+    free(state->victim_lists);
+    free(state->victim_units);
+    state->victim_lists = NULL;
+    state->victim_units = NULL;
+    free(state->preempt_need);
+    free(state->preempt_missing);
+    free(state->preempt_held);
+    free(state->preempt_cursor);
+    free(state->preempt_victims);
+    state->preempt_need = NULL;
+    state->preempt_missing = NULL;
+    state->preempt_held = NULL;
+    state->preempt_cursor = NULL;
+    state->preempt_victims = NULL;
+}
+
+// Indexes every rescuer by type and position, builds the rescore lists
+// and the waiting index,
+// the preemption index and its planner's scratch and one lock per rescuer
+// type; all rescuers start IDLE.
+static int runtime_fleet_init(runtime_state_t* state, const environment_variable_t* environment) {
+    size_t type_count = state->type_index->rescuer_type_count;
+    size_t kind_count = state->type_index->count;
+    size_t slots = state->rescuer_count ? state->rescuer_count : 1;
+    state->victim_lists = calloc(RUNTIME_PRIORITY_LEVELS * (kind_count + 1), sizeof(emergency_record_t*));
+    state->victim_units = calloc(RUNTIME_PRIORITY_LEVELS * (type_count + 1), sizeof(size_t));
+    state->preempt_need = calloc(type_count + 1, sizeof(long long));
+    state->preempt_missing = calloc(type_count + 1, sizeof(long long));
+    state->preempt_held = calloc(type_count + 1, sizeof(long long));
+    state->preempt_cursor = calloc(kind_count + 1, sizeof(emergency_record_t*));
+    state->preempt_victims = calloc(slots, sizeof(emergency_record_t*));
+    state->rescuer_type_ids = calloc(slots, sizeof(int));
+    state->rescore_units = calloc(slots, sizeof(int));
+    state->rescore_flag = calloc(slots, sizeof(unsigned char));
+    state->rescore_start = calloc(type_count + 1, sizeof(size_t));
+    state->rescore_count = calloc(type_count + 1, sizeof(size_t));
+    state->rescore_kept = calloc(type_count + 1, sizeof(size_t));
+    if (!state->victim_lists || !state->victim_units || !state->preempt_need || !state->preempt_missing ||
+        !state->preempt_held || !state->preempt_cursor || !state->preempt_victims || !state->rescuer_type_ids || !state->rescore_units || !state->rescore_flag || !state->rescore_start ||
+        !state->rescore_count || !state->rescore_kept) {
+        runtime_fleet_destroy(state);
+        return -1;
+    }
+    for (size_t i = 0; i < state->rescuer_count; ++i) {
+        int type_id = emergency_type_index_rescuer_id(state->type_index, state->rescuer_pool[i].type);
+        state->rescuer_type_ids[i] = type_id;
+        if (type_id >= 0) {
+            ++state->rescore_start[type_id + 1];
+        }
+    }
+    for (size_t t = 0; t < type_count; ++t) {
+        state->rescore_start[t + 1] += state->rescore_start[t];
+    }
+    atomic_init(&state->rescore_pending, 0);
+
+    if (rescuer_grid_init(&state->available_grid,
+                          environment ? environment->width : 0,
+                          environment ? environment->height : 0,
+                          state->type_index->rescuer_types,
+                          type_count,
+                          state->rescuer_type_ids,
+                          state->rescuer_count) != 0 ||
+        waiting_index_init(&state->waiting_index,
+                           environment ? environment->width : 0,
+                           environment ? environment->height : 0,
+                           type_count,
+                           state->rescuer_count) != 0) {
+        runtime_fleet_destroy(state);
+        return -1;
+    }
+
+    state->type_locks = calloc(type_count ? type_count : 1, sizeof(pthread_mutex_t));
+    if (!state->type_locks) {
+        runtime_fleet_destroy(state);
+        return -1;
+    }
+    for (; state->type_lock_count < type_count; ++state->type_lock_count) {
+        if (pthread_mutex_init(&state->type_locks[state->type_lock_count], NULL) != 0) {
+            runtime_fleet_destroy(state);
+            return -1;
+        }
+    }
+
+    for (size_t i = 0; i < state->rescuer_count; ++i) {
+        rescuer_grid_place(&state->available_grid, (int)i, &state->rescuer_pool[i]);
+    }
+    return 0;
+}
+
+static int runtime_batch_create(runtime_state_t* state);
+static void runtime_batch_free(runtime_state_t* state);
+
+// Carves the record slab, sized with record_units for the most units an
+// emergency type needs, sizes the waiting heap for as many records and the
+// active list for one per rescuer, the most that can hold units, and sets
+// up the buffers of the batched rounds if they are on.
+static int runtime_records_init(runtime_state_t* state, const environment_variable_t* environment) {
+    const emergency_type_index_t* index = state->type_index;
+    for (size_t i = 0; i < index->count; ++i) {
+        if (index->descriptors[i].total_units > 0 && (size_t)index->descriptors[i].total_units > state->record_units) {
+            state->record_units = (size_t)index->descriptors[i].total_units;
+        }
+    }
+
+    size_t reserve = state->rescuer_count + RUNTIME_RECORD_RESERVE;
+    if (environment) {
+        // The depth the consumers give each shard's queue, the largest the
+        // system allows when mq_max_messages is 0.
+        mq_consumer_limits_t limits;
+        struct mq_attr attr;
+        size_t shards = environment->mq_shards ? environment->mq_shards : 1;
+        mq_consumer_probe_limits(&limits);
+        mq_consumer_choose_attributes(environment, &limits, shards, &attr);
+        reserve += (size_t)attr.mq_maxmsg * shards;
+    }
+    if (slab_allocator_init(&state->record_slab, record_object_size(state->record_units), reserve) != 0) {
+        return -1;
+    }
+    if (waiting_heap_reserve(&state->waiting, reserve) != 0 ||
+        ensure_capacity(&state->active_emergencies, &state->active_capacity, 0, state->rescuer_count) != 0 ||
+        (environment && environment->batch_window_ms > 0 && runtime_batch_create(state) != 0)) {
+        waiting_heap_destroy(&state->waiting);
+        free(state->active_emergencies);
+        state->active_emergencies = NULL;
+        state->active_capacity = 0;
+        slab_allocator_destroy(&state->record_slab);
+        return -1;
+    }
+    return 0;
+}
+
+// Reports what one queued emergency and one rescuer cost in memory, what a
+// backlog of RUNTIME_MEMORY_BACKLOG emergencies would take, and how many
+// records the slab reserved at start.
+static void runtime_log_memory(runtime_state_t* state) {
+    size_t per_record = state->record_slab.object_size + sizeof(emergency_record_t*); // slab object, heap slot
+    size_t per_rescuer = sizeof(rescuer_digital_twin_t) +
+                         sizeof(timer_wheel_entry_t) +          // return timer
+                         2 * sizeof(int) + 1 +                   // type ID, rescore entry and flag
+                         3 * sizeof(int) +                       // grid links and bucket
+                         sizeof(emergency_record_t*) +           // waiting index list
+                         2 * sizeof(emergency_record_t*);        // active and preemption slots
+    if (state->batch) {
+        per_rescuer += 2 * sizeof(int) + 2; // candidates, columns, taken, in_columns
+    }
+    double backlog_mib = (double)per_record * RUNTIME_MEMORY_BACKLOG / (1024.0 * 1024.0);
+    size_t reserved = slab_allocator_capacity(&state->record_slab);
+    LOG_SYSTEM("RT-MEMORY",
+               "%zu bytes per queued emergency (up to %zu units), %zu per rescuer; "
+               "%d queued emergencies would take %.1f MiB, the %zu rescuers %.1f KiB; "
+               "%zu records reserved (%.1f MiB)",
+               per_record,
+               state->record_units,
+               per_rescuer,
+               RUNTIME_MEMORY_BACKLOG,
+               backlog_mib,
+               state->rescuer_count,
+               (double)(per_rescuer * state->rescuer_count) / 1024.0,
+               reserved,
+               (double)(per_record * reserved) / (1024.0 * 1024.0));
+}
+static void* runtime_worker_thread(void* arg);
+static void* runtime_monitor_thread(void* arg);
+static void* runtime_ingest_thread(void* arg);
+
+int runtime_state_init(runtime_state_t* state,
+                       rescuer_digital_twin_t* rescuers,
+                       size_t rescuer_count,
+                       const environment_variable_t* environment,
+                       const emergency_type_index_t* type_index,
+                       const runtime_clock_t* clock) {
+    if (!state || !type_index) {
+        return -1;
+    }
+
+    memset(state, 0, sizeof(*state));
+    state->type_index = type_index;
+    state->clock = clock;
+
+    if (pthread_mutex_init(&state->mutex, NULL) != 0) {
+        return -1;
+    }
+
+    if (pthread_cond_init(&state->progress_cond, NULL) != 0) {
+        pthread_mutex_destroy(&state->mutex);
+        return -1;
+    }
+
+    if (pthread_cond_init(&state->timer_cond, NULL) != 0) {
+        pthread_cond_destroy(&state->progress_cond);
+        pthread_mutex_destroy(&state->mutex);
+        return -1;
+    }
+    timer_wheel_init(&state->timers, runtime_state_now(state));
+
+    if (handoff_ring_init(&state->ingest_ring, RUNTIME_HANDOFF_CAPACITY) != 0) {
+        pthread_cond_destroy(&state->progress_cond);
+        pthread_cond_destroy(&state->timer_cond);
+        pthread_mutex_destroy(&state->mutex);
+        return -1;
+    }
+
+    if (sem_init(&state->ingest_doorbell, 0, 0) != 0) {
+        handoff_ring_destroy(&state->ingest_ring);
+        pthread_cond_destroy(&state->progress_cond);
+        pthread_cond_destroy(&state->timer_cond);
+        pthread_mutex_destroy(&state->mutex);
+        return -1;
+    }
+    atomic_init(&state->ingest_closed, false);
+
+    if (rescuer_count > 0) {
+        if (!rescuers) {
+            sem_destroy(&state->ingest_doorbell);
+            handoff_ring_destroy(&state->ingest_ring);
+            pthread_cond_destroy(&state->progress_cond);
+            pthread_cond_destroy(&state->timer_cond);
+            pthread_mutex_destroy(&state->mutex);
+            return -1;
+        }
+        state->return_timers = calloc(rescuer_count, sizeof(timer_wheel_entry_t));
+        if (!state->return_timers) {
+            sem_destroy(&state->ingest_doorbell);
+            handoff_ring_destroy(&state->ingest_ring);
+            pthread_cond_destroy(&state->progress_cond);
+            pthread_cond_destroy(&state->timer_cond);
+            pthread_mutex_destroy(&state->mutex);
+            return -1;
+        }
+
+        state->rescuer_pool = rescuers;
+        for (size_t i = 0; i < rescuer_count; ++i) {
+            state->rescuer_pool[i].status = IDLE;
+            state->rescuer_pool[i].return_available_at = 0;
+            timer_wheel_entry_init(&state->return_timers[i], RUNTIME_TIMER_RETURN);
+        }
+    }
+    state->rescuer_count = rescuer_count;
+
+    if (runtime_fleet_init(state, environment) != 0 || runtime_records_init(state, environment) != 0) {
+        runtime_fleet_destroy(state);
+        free(state->return_timers);
+        state->rescuer_pool = NULL;
+        state->return_timers = NULL;
+        state->rescuer_count = 0;
+        sem_destroy(&state->ingest_doorbell);
+        handoff_ring_destroy(&state->ingest_ring);
+        pthread_cond_destroy(&state->progress_cond);
+        pthread_cond_destroy(&state->timer_cond);
+        pthread_mutex_destroy(&state->mutex);
+        return -1;
+    }
     for (size_t i = 0; i < RUNTIME_PRIORITY_LEVELS; ++i) {
         unsigned int fallback = (i == 0) ? RUNTIME_DEFAULT_TIMEOUT_LOW
                                          : (i == 1 ? RUNTIME_DEFAULT_TIMEOUT_MEDIUM
@@ -568,8 +1370,28 @@ int runtime_state_init(runtime_state_t* state,
     if (state->aging_step_seconds == 0) {
         state->aging_step_seconds = RUNTIME_DEFAULT_AGING_STEP;
     }
+    state->batch_window_ms = environment ? environment->batch_window_ms : 0;
+    state->min_workers = environment ? environment->min_workers : 0;
+    state->max_workers = environment ? environment->max_workers : 0;
+    if (state->min_workers == 0) {
+        state->min_workers = RUNTIME_DEFAULT_WORKERS;
+    }
+    if (state->max_workers == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        state->max_workers = online > 0 ? (size_t)online : state->min_workers;
+        if (state->max_workers > RUNTIME_MAX_WORKERS) {
+            state->max_workers = RUNTIME_MAX_WORKERS;
+        }
+    }
+    // Only the defaults can cross: explicit limits are validated at start.
+    if (state->max_workers < state->min_workers) {
+        state->max_workers = state->min_workers;
+    }
+    timer_wheel_entry_init(&state->scale_timer, RUNTIME_TIMER_SCALE);
+    assignment_solver_init(&state->batch_solver);
     state->monitor_running = 0;
     state->shutdown_requested = 0;
+    runtime_log_memory(state);
 
     return 0;
 }
@@ -582,55 +1404,240 @@ void runtime_state_destroy(runtime_state_t* state) {
     runtime_state_request_shutdown(state);
     runtime_state_join_workers(state);
 
+    LOG_SYSTEM("RT-HANDOFF-STATS",
+               "Handoff ring: capacity=%zu pushed=%llu overflows=%llu high_water=%zu",
+               handoff_ring_capacity(&state->ingest_ring),
+               (unsigned long long)atomic_load(&state->ingest_ring.pushed),
+               (unsigned long long)atomic_load(&state->ingest_ring.overflows),
+               (size_t)atomic_load(&state->ingest_ring.high_water));
+
     runtime_state_clear_arrays(state);
-    free(state->rescuer_pool);
+    runtime_batch_free(state);
+    slab_allocator_destroy(&state->record_slab);
+    handoff_ring_destroy(&state->ingest_ring);
+    sem_destroy(&state->ingest_doorbell);
+    free_rescuer_twins(state->rescuer_pool);
     state->rescuer_pool = NULL;
+    free(state->return_timers);
+    state->return_timers = NULL;
+    runtime_fleet_destroy(state);
+    assignment_solver_destroy(&state->batch_solver);
     state->rescuer_count = 0;
 
-    pthread_cond_destroy(&state->rescuer_available_cond);
-    pthread_cond_destroy(&state->emergency_available_cond);
     pthread_cond_destroy(&state->progress_cond);
+    pthread_cond_destroy(&state->timer_cond);
     pthread_mutex_destroy(&state->mutex);
 }
 
-int runtime_state_start_workers(runtime_state_t* state, size_t worker_count) {
-    if (!state) {
+static void runtime_workers_free(runtime_state_t* state, size_t cond_count) {
+    for (size_t i = 0; i < cond_count; ++i) {
+        pthread_cond_destroy(&state->workers[i].wake);
+    }
+    free(state->workers);
+    free(state->idle_workers);
+    free(state->rescuer_waiters);
+    state->workers = NULL;
+    state->idle_workers = NULL;
+    state->rescuer_waiters = NULL;
+    state->worker_count = 0;
+    state->worker_capacity = 0;
+    state->idle_count = 0;
+    state->rescuer_wait_count = 0;
+}
+
+// Starts a thread in the first free slot. A slot left by a retired worker
+// is joined first; that thread has already dropped mutex for good.
+static int runtime_worker_spawn_locked(runtime_state_t* state) {
+    if (state->worker_count >= state->worker_capacity) {
         return -1;
     }
 
-    if (worker_count == 0) {
-        worker_count = RUNTIME_DEFAULT_WORKERS;
+    runtime_worker_t* worker = &state->workers[state->worker_count];
+    if (worker->started) {
+        pthread_join(worker->thread, NULL);
+        worker->started = false;
+    }
+    worker->idle = false;
+    worker->waiting_rescuers = false;
+    worker->units_woken = false;
+    worker->retiring = false;
+    if (pthread_create(&worker->thread, NULL, runtime_worker_thread, worker) != 0) {
+        return -1;
     }
+    worker->started = true;
+    ++state->worker_count;
+    return 0;
+}
 
-    state->workers = calloc(worker_count, sizeof(pthread_t));
-    if (!state->workers) {
+// Run by a retiring worker, always the top slot, on its way out: its
+// queued steps move to worker 0 and the slot is freed.
+static void runtime_worker_retire_locked(runtime_state_t* state, runtime_worker_t* worker) {
+    --state->worker_count;
+    state->retire_pending = false;
+    if (state->worker_count == 0) {
+        return;
+    }
+
+    runtime_worker_t* heir = &state->workers[0];
+    timer_wheel_entry_t* step;
+    bool moved = false;
+    while ((step = timer_wheel_list_pop_front(&worker->steps)) != NULL) {
+        timer_wheel_list_push(&heir->steps, step);
+        moved = true;
+    }
+    if (moved && (heir->idle || heir->waiting_rescuers)) {
+        worker_unpark_locked(state, heir);
+    }
+}
+
+static unsigned int runtime_wait_p90_locked(const runtime_state_t* state) {
+    size_t target = (state->wait_samples * 9 + 9) / 10;
+    size_t seen = 0;
+    for (unsigned int bucket = 0; bucket < RUNTIME_WAIT_BUCKETS; ++bucket) {
+        seen += state->wait_histogram[bucket];
+        if (seen >= target) {
+            return bucket;
+        }
+    }
+    return RUNTIME_WAIT_BUCKETS - 1;
+}
+
+// One controller tick. Adding workers only helps when the ones running are
+// all busy: with one idle there is spare capacity, and with one parked for
+// units the head of the queue is waiting on the fleet, which more threads
+// would not change.
+static void runtime_scale_workers_locked(runtime_state_t* state, time_t now) {
+    size_t backlog = waiting_heap_count(&state->waiting);
+    unsigned int p90 = state->wait_samples > 0 ? runtime_wait_p90_locked(state) : 0;
+    size_t blocked = 0;
+    for (size_t i = 0; i < state->worker_count; ++i) {
+        blocked += state->workers[i].waiting_rescuers ? 1 : 0;
+    }
+    bool saturated = state->idle_count == 0 && blocked == 0;
+    bool pressure = backlog > state->worker_count * RUNTIME_SCALE_BACKLOG || p90 >= RUNTIME_SCALE_WAIT_P90;
+
+    if (pressure && saturated) {
+        state->scale_down_ticks = 0;
+        ++state->scale_up_ticks;
+    } else if (state->idle_count > 0 && backlog == 0) {
+        state->scale_up_ticks = 0;
+        ++state->scale_down_ticks;
+    } else {
+        state->scale_up_ticks = 0;
+        state->scale_down_ticks = 0;
+    }
+
+    size_t before = state->worker_count;
+    if (!state->retire_pending && state->scale_up_ticks >= RUNTIME_SCALE_UP_TICKS &&
+        state->worker_count < state->max_workers) {
+        state->scale_up_ticks = 0;
+        if (runtime_worker_spawn_locked(state) == 0) {
+            LOG_SYSTEM("RT-SCALE-UP",
+                       "Worker pool %zu -> %zu: backlog=%zu p90_wait=%us idle=%zu blocked=%zu",
+                       before,
+                       state->worker_count,
+                       backlog,
+                       p90,
+                       state->idle_count,
+                       blocked);
+        } else {
+            LOG_SYSTEM("RT-SCALE-ERROR", "Failed to start worker %zu", before);
+        }
+    } else if (!state->retire_pending && state->scale_down_ticks >= RUNTIME_SCALE_DOWN_TICKS &&
+               state->worker_count > state->min_workers) {
+        state->scale_down_ticks = 0;
+        runtime_worker_t* worker = &state->workers[state->worker_count - 1];
+        worker->retiring = true;
+        state->retire_pending = true;
+        worker_unpark_locked(state, worker);
+        LOG_SYSTEM("RT-SCALE-DOWN",
+                   "Worker pool %zu -> %zu: backlog=%zu p90_wait=%us idle=%zu",
+                   before,
+                   before - 1,
+                   backlog,
+                   p90,
+                   state->idle_count);
+    }
+
+    memset(state->wait_histogram, 0, sizeof(state->wait_histogram));
+    state->wait_samples = 0;
+    runtime_timer_schedule_locked(state, &state->scale_timer, now + RUNTIME_SCALE_INTERVAL);
+}
+
+int runtime_state_start_workers(runtime_state_t* state, size_t worker_count) {
+    if (!state) {
         return -1;
     }
 
-    state->worker_count = worker_count;
+    if (worker_count > 0) {
+        state->min_workers = worker_count;
+        state->max_workers = worker_count;
+    }
 
-    for (size_t i = 0; i < worker_count; ++i) {
-        if (pthread_create(&state->workers[i], NULL, runtime_worker_thread, state) != 0) {
-            state->worker_count = i;
-            runtime_state_request_shutdown(state);
-            runtime_state_join_workers(state);
-            free(state->workers);
-            state->workers = NULL;
+    // Consumers may already be dispatching, and admitting records wakes
+    // workers, so the pool is published under mutex.
+    pthread_mutex_lock(&state->mutex);
+    size_t capacity = state->max_workers;
+    state->workers = calloc(capacity, sizeof(runtime_worker_t));
+    state->idle_workers = calloc(capacity, sizeof(size_t));
+    state->rescuer_waiters = calloc((state->type_index->rescuer_type_count + 1) * capacity, 1);
+    if (!state->workers || !state->idle_workers || !state->rescuer_waiters) {
+        runtime_workers_free(state, 0);
+        pthread_mutex_unlock(&state->mutex);
+        return -1;
+    }
+    for (size_t i = 0; i < capacity; ++i) {
+        runtime_worker_t* worker = &state->workers[i];
+        worker->state = state;
+        worker->id = i;
+        timer_wheel_list_init(&worker->steps);
+        if (pthread_cond_init(&worker->wake, NULL) != 0) {
+            runtime_workers_free(state, i);
+            pthread_mutex_unlock(&state->mutex);
             return -1;
         }
     }
+    state->worker_capacity = capacity;
+
+    int rc = 0;
+    while (rc == 0 && state->worker_count < state->min_workers) {
+        rc = runtime_worker_spawn_locked(state);
+    }
+    pthread_mutex_unlock(&state->mutex);
+    if (rc != 0) {
+        runtime_state_request_shutdown(state);
+        runtime_state_join_workers(state);
+        return -1;
+    }
 
     if (pthread_create(&state->monitor_thread, NULL, runtime_monitor_thread, state) != 0) {
         state->monitor_running = 0;
         runtime_state_request_shutdown(state);
         runtime_state_join_workers(state);
-        free(state->workers);
-        state->workers = NULL;
         return -1;
     }
     state->monitor_running = 1;
 
-    LOG_SYSTEM("RT-WORKERS", "Runtime dispatcher started with %zu workers", worker_count);
+    if (pthread_create(&state->ingest_thread, NULL, runtime_ingest_thread, state) != 0) {
+        runtime_state_request_shutdown(state);
+        runtime_state_join_workers(state);
+        return -1;
+    }
+    state->ingest_running = 1;
+
+    if (state->max_workers > state->min_workers) {
+        pthread_mutex_lock(&state->mutex);
+        runtime_timer_schedule_locked(state,
+                                      &state->scale_timer,
+                                      runtime_state_now(state) + RUNTIME_SCALE_INTERVAL);
+        pthread_mutex_unlock(&state->mutex);
+    }
+
+    LOG_SYSTEM("RT-WORKERS",
+               "Runtime dispatcher started with %zu workers (min=%zu max=%zu)",
+               state->worker_count,
+               state->min_workers,
+               state->max_workers);
     return 0;
 }
 
@@ -639,12 +1646,18 @@ void runtime_state_request_shutdown(runtime_state_t* state) {
         return;
     }
 
+    atomic_store(&state->ingest_closed, true);
+
     pthread_mutex_lock(&state->mutex);
     state->shutdown_requested = 1;
-    pthread_cond_broadcast(&state->emergency_available_cond);
-    pthread_cond_broadcast(&state->rescuer_available_cond);
+    for (size_t i = 0; i < state->worker_count; ++i) {
+        pthread_cond_signal(&state->workers[i].wake);
+    }
     pthread_cond_broadcast(&state->progress_cond);
+    pthread_cond_broadcast(&state->timer_cond);
     pthread_mutex_unlock(&state->mutex);
+
+    sem_post(&state->ingest_doorbell);
 }
 
 void runtime_state_join_workers(runtime_state_t* state) {
@@ -652,618 +1665,1408 @@ void runtime_state_join_workers(runtime_state_t* state) {
         return;
     }
 
-    if (state->workers) {
-        for (size_t i = 0; i < state->worker_count; ++i) {
-            pthread_join(state->workers[i], NULL);
-        }
-        free(state->workers);
-        state->workers = NULL;
-        state->worker_count = 0;
-    }
-
+    // The monitor runs the pool controller, so it goes first: once it is
+    // gone no worker can be started.
     if (state->monitor_running) {
         pthread_join(state->monitor_thread, NULL);
         state->monitor_running = 0;
     }
+
+    for (size_t i = 0; i < state->worker_capacity; ++i) {
+        if (state->workers[i].started) {
+            pthread_join(state->workers[i].thread, NULL);
+            state->workers[i].started = false;
+        }
+    }
+
+    if (state->ingest_running) {
+        pthread_join(state->ingest_thread, NULL);
+        state->ingest_running = 0;
+    }
+
+    if (state->workers) {
+        // Steps left queued belong to records still active; they are
+        // detached here and the records destroyed with the runtime.
+        pthread_mutex_lock(&state->mutex);
+        for (size_t i = 0; i < state->worker_capacity; ++i) {
+            runtime_worker_t* worker = &state->workers[i];
+            while (timer_wheel_list_pop_front(&worker->steps) != NULL) {
+            }
+            if (worker->dispatched > 0 || worker->steps_run > 0 || i < state->worker_count) {
+                LOG_SYSTEM("RT-WORKER-STATS",
+                           "Worker %zu: dispatched=%zu steps=%zu stolen=%zu unit_wakeups=%zu spurious=%zu",
+                           worker->id,
+                           worker->dispatched,
+                           worker->steps_run,
+                           worker->steps_stolen,
+                           worker->unit_wakeups,
+                           worker->spurious_wakeups);
+            }
+        }
+        timer_wheel_cancel(&state->scale_timer);
+        runtime_workers_free(state, state->worker_capacity);
+        pthread_mutex_unlock(&state->mutex);
+    }
 }
 
+// Fills in everything that does not depend on the fleet, so it can run on
+// the ingestion threads without the runtime lock.
 static int emergency_record_prepare(emergency_record_t* record,
                                     const emergency_request_t* request,
-                                    const emergency_type_t* type,
-                                    const runtime_state_t* state) {
-    if (!record || !request || !type) {
+                                    const emergency_type_descriptor_t* descriptor) {
+    if (!record || !request || !descriptor) {
         return -1;
     }
 
     memset(record, 0, sizeof(*record));
-    record->emergency.status = WAITING;
-    record->emergency.type = *type;
-    record->emergency.x = request->x;
-    record->emergency.y = request->y;
-    record->emergency.time = request->timestamp;
-    record->emergency.timer_started_at = 0;
-    record->emergency.deadline = 0;
-    record->emergency.elapsed_timer_seconds = 0;
-    record->emergency.dynamic_priority = type->priority;
-    record->emergency.rescuer_count = 0;
-    record->emergency.rescuers_dt = NULL;
-    strncpy(record->emergency.name, request->emergency_name, sizeof(record->emergency.name) - 1);
-
-    if (type->rescuer_requests && type->rescuers_req_number > 0) {
-        int total = 0;
-        for (int i = 0; i < type->rescuers_req_number; ++i) {
-            if (type->rescuer_requests[i].required_count > 0) {
-                total += type->rescuer_requests[i].required_count;
-            }
-        }
-        if (total > 0) {
-            record->emergency.rescuer_count = total;
-        }
+    record->descriptor = descriptor;
+    record->status = WAITING;
+    record->x = request->x;
+    record->y = request->y;
+    record->requested_at = request->timestamp;
+    record->timer_started_at = 0;
+    record->deadline = 0;
+    record->dynamic_priority = descriptor->type->priority;
+
+    record->manage_time_total = descriptor->max_manage_time;
+    record->manage_time_remaining = record->manage_time_total;
+    record->heap_index = WAITING_HEAP_NOT_QUEUED;
+    record->active_index = RUNTIME_NOT_ACTIVE;
+    record->nearest_unit = -1;
+    record->nearest_list = WAITING_INDEX_NONE;
+    record->waiting_cell = WAITING_INDEX_NONE;
+    record->victim_level = -1;
+    timer_wheel_entry_init(&record->deadline_timer, RUNTIME_TIMER_DEADLINE);
+    timer_wheel_entry_init(&record->aging_timer, RUNTIME_TIMER_AGING);
+    timer_wheel_entry_init(&record->phase_timer, RUNTIME_TIMER_PHASE);
+
+    return 0;
+}
+
+static emergency_record_t* emergency_record_create(runtime_state_t* state, const emergency_request_t* request) {
+    // Consumers resolve names before dispatching; the lookup here only covers
+    // callers that pass a bare name.
+    int type_id = request->type_id;
+    if (type_id < 0) {
+        type_id = emergency_type_index_lookup(state->type_index, request->emergency_name);
     }
 
-    record->min_distance = compute_min_distance(state, request->x, request->y);
-    if (record->min_distance == INT_MAX) {
-        record->min_distance = 1000000;
+    const emergency_type_descriptor_t* descriptor = emergency_type_index_get(state->type_index, type_id);
+    if (!descriptor) {
+        LOG_EMERGENCY_STATUS("RT-DISPATCH-UNKNOWN", "Unknown emergency type '%s'", request->emergency_name);
+        return NULL;
     }
 
-    int priority = emergency_effective_priority(record);
-    record->priority_score = priority * 100000 - record->min_distance;
+    emergency_record_t* record = slab_allocator_alloc(&state->record_slab);
+    if (!record) {
+        return NULL;
+    }
 
-    record->manage_time_total = compute_management_time_seconds(record);
-    record->manage_time_remaining = record->manage_time_total;
-    record->preempted = false;
+    if (emergency_record_prepare(record, request, descriptor) != 0) {
+        slab_allocator_free(&state->record_slab, record);
+        return NULL;
+    }
+
+    return record;
+}
+
+static void emergency_record_admit_locked(runtime_state_t* state, emergency_record_t* record) {
+    runtime_lock_types(state, record->descriptor);
+    update_record_priority_locked(state, record);
+    runtime_unlock_types(state, record->descriptor);
 
     LOG_EMERGENCY_STATUS("RT-DISPATCH-QUEUE",
                          "Emergency '%s' queued with priority=%d min_distance=%d",
-                         record->emergency.name,
+                         emergency_record_name(record),
                          record->priority_score,
                          record->min_distance);
 
-    return 0;
+    emergency_timer_start(state, record);
+    waiting_queue_insert_locked(state, record);
 }
 
-int runtime_state_dispatch_request(runtime_state_t* state,
-                                   const emergency_request_t* request,
-                                   const emergency_type_t* emergency_types,
-                                   size_t emergency_type_count) {
-    if (!state || !request || !emergency_types || emergency_type_count == 0) {
-        return -1;
+// Moves every record handed off by the consumers into the waiting queue.
+// Holding the mutex makes the caller the ring's single consumer.
+static size_t ingest_splice_locked(runtime_state_t* state) {
+    void* items[RUNTIME_SPLICE_CHUNK];
+    size_t total = 0;
+    size_t popped;
+
+    while ((popped = handoff_ring_pop_bulk(&state->ingest_ring, items, RUNTIME_SPLICE_CHUNK)) > 0) {
+        for (size_t i = 0; i < popped; ++i) {
+            emergency_record_admit_locked(state, (emergency_record_t*)items[i]);
+        }
+        total += popped;
     }
 
-    pthread_mutex_lock(&state->mutex);
+    if (total > 0) {
+        wake_workers_locked(state, total);
+        rekey_rescuer_waiters_locked(state);
+    }
 
-    if (state->shutdown_requested) {
-        pthread_mutex_unlock(&state->mutex);
+    return total;
+}
+
+void runtime_state_release_thread_cache(runtime_state_t* state) {
+    if (state) {
+        slab_allocator_release_thread_cache(&state->record_slab);
+    }
+}
+
+time_t runtime_state_now(const runtime_state_t* state) {
+    return runtime_clock_now(state ? state->clock : NULL);
+}
+
+int runtime_state_dispatch_request(runtime_state_t* state, const emergency_request_t* request) {
+    if (!state || !request) {
         return -1;
     }
 
-    const emergency_type_t* type = find_emergency_type(emergency_types, emergency_type_count, request->emergency_name);
-    if (!type) {
-        LOG_EMERGENCY_STATUS("RT-DISPATCH-UNKNOWN", "Unknown emergency type '%s'", request->emergency_name);
-        pthread_mutex_unlock(&state->mutex);
+    return runtime_state_dispatch_batch(state, request, 1) == 1 ? 0 : -1;
+}
+
+int runtime_state_dispatch_batch(runtime_state_t* state,
+                                 const emergency_request_t* requests,
+                                 size_t request_count) {
+    if (!state || !requests) {
         return -1;
     }
 
-    emergency_record_t* record = calloc(1, sizeof(*record));
-    if (!record) {
-        pthread_mutex_unlock(&state->mutex);
+    if (atomic_load(&state->ingest_closed)) {
         return -1;
     }
 
-    if (emergency_record_prepare(record, request, type, state) != 0) {
-        emergency_record_destroy(record);
+    size_t enqueued = 0;
+    for (size_t i = 0; i < request_count; ++i) {
+        emergency_record_t* record = emergency_record_create(state, &requests[i]);
+        if (!record) {
+            LOG_EMERGENCY_STATUS("RT-DISPATCH-FAIL",
+                                 "Failed to enqueue emergency '%s' from batch",
+                                 requests[i].emergency_name);
+            continue;
+        }
+
+        if (handoff_ring_push(&state->ingest_ring, record)) {
+            ++enqueued;
+            continue;
+        }
+
+        // The ring is full: fall back to the locked path rather than drop the
+        // emergency. The overflow counter in the ring records how often.
+        pthread_mutex_lock(&state->mutex);
+        if (state->shutdown_requested) {
+            pthread_mutex_unlock(&state->mutex);
+            emergency_record_destroy(state, record);
+            continue;
+        }
+        ingest_splice_locked(state);
+        emergency_record_admit_locked(state, record);
+        wake_workers_locked(state, 1);
+        rekey_rescuer_waiters_locked(state);
         pthread_mutex_unlock(&state->mutex);
-        return -1;
+        ++enqueued;
+    }
+
+    if (enqueued > 0) {
+        sem_post(&state->ingest_doorbell);
+    }
+
+    return (int)enqueued;
+}
+
+// Picks the nearest dispatchable unit for each one the record is missing
+// and writes them after the units it holds, in its own slab object, to be
+// claimed and then counted in by runtime_assign_record_locked(); the units
+// are out of the grid on success, untouched on failure.
+static bool try_allocate_rescuers_locked(runtime_state_t* state, emergency_record_t* record, size_t* out_count) {
+    if (!state || !record || !out_count) {
+        return false;
+    }
+
+    const emergency_type_index_t* index = state->type_index;
+    int* selections = record->assigned_indices + record->assigned_count;
+    size_t selection_index = 0;
+
+    time_t now = runtime_state_now(state);
+
+    for (size_t type_id = 0; type_id < index->rescuer_type_count; ++type_id) {
+        int required = record_missing_units(state, record, type_id);
+        if (required <= 0) {
+            continue;
+        }
+        for (int needed = 0; needed < required; ++needed) {
+            int best_index = rescuer_grid_nearest(&state->available_grid,
+                                                  (int)type_id,
+                                                  state->rescuer_pool,
+                                                  record->x,
+                                                  record->y,
+                                                  now);
+            if (best_index < 0) {
+                // Put back the units taken out for this attempt.
+                for (size_t i = 0; i < selection_index; ++i) {
+                    rescuer_grid_place(&state->available_grid, selections[i], &state->rescuer_pool[selections[i]]);
+                }
+                return false;
+            }
+
+            // Out of the index until the caller changes its status, so the
+            // next query cannot pick it again.
+            rescuer_grid_remove(&state->available_grid, best_index);
+            selections[selection_index++] = best_index;
+        }
     }
 
+    *out_count = selection_index;
+    return true;
+}
+
+// Where a unit that set off from its position at started_at towards (x, y)
+// is at now: speed cells a second, along x first and then y.
+static void rescuer_advance_locked(runtime_state_t* state, int index, int x, int y, time_t started_at, time_t now) {
+    rescuer_digital_twin_t* rescuer = &state->rescuer_pool[index];
+    long long speed = rescuer->type && rescuer->type->speed > 0 ? rescuer->type->speed : 1;
+    long long covered = now > started_at ? (long long)(now - started_at) * speed : 0;
+    long long dx = (long long)x - rescuer->x;
+    long long dy = (long long)y - rescuer->y;
+    long long along_x = dx < 0 ? -dx : dx;
+    long long along_y = dy < 0 ? -dy : dy;
+    if (covered == 0 || (along_x == 0 && along_y == 0)) {
+        return;
+    }
+
+    int new_x = x;
+    int new_y = y;
+    if (covered < along_x) {
+        new_x = rescuer->x + (int)(dx < 0 ? -covered : covered);
+        new_y = rescuer->y;
+    } else if (covered < along_x + along_y) {
+        new_y = rescuer->y + (int)(dy < 0 ? -(covered - along_x) : covered - along_x);
+    }
+    update_rescuer_position_locked(state, index, new_x, new_y);
+}
+
+// Sends a preempted emergency back to the waiting queue with the units it
+// kept, if any; the caller has already taken the others and saved the
+// remaining management time.
+static void requeue_preempted_emergency_locked(runtime_state_t* state, emergency_record_t* record) {
+    if (!state || !record) {
+        return;
+    }
+
+    timer_wheel_cancel(&record->phase_timer);
+    if (record->assigned_count == 0) {
+        active_list_remove_locked(state, record);
+    }
+
+    update_record_priority_locked(state, record);
     emergency_timer_start(state, record);
     waiting_queue_insert_locked(state, record);
-    pthread_cond_signal(&state->emergency_available_cond);
-    pthread_mutex_unlock(&state->mutex);
-    return 0;
+    wake_workers_locked(state, 1);
 }
 
-static bool try_allocate_rescuers_locked(runtime_state_t* state,
-                                         emergency_record_t* record,
-                                         int** out_indices,
-                                         size_t* out_count) {
-    if (!state || !record || !out_indices || !out_count) {
+// Takes from a victim the units of the types target is still short of
+// (need, per type), nearest to target first, and leaves them dispatchable
+// where they stand: a trip under way stops at the point it has reached.
+// The victim keeps its other units and waits, PAUSED, for replacements of
+// the ones it lost. Returns the number of units taken. Needs mutex and
+// every type lock; the victim must be out of the preemption index.
+static size_t preempt_units_locked(runtime_state_t* state,
+                                   emergency_record_t* victim,
+                                   const emergency_record_t* target,
+                                   long long* need,
+                                   time_t now) {
+    size_t held = victim->assigned_count;
+    if (victim->status == ASSIGNED) {
+        for (size_t i = 0; i < held; ++i) {
+            rescuer_advance_locked(state,
+                                   victim->assigned_indices[i],
+                                   victim->x,
+                                   victim->y,
+                                   victim->travel_started_at,
+                                   now);
+        }
+    }
+
+    size_t taken = 0;
+    for (size_t i = 0; i < victim->assigned_count;) {
+        // Nearest unit of a type still needed, from i on.
+        size_t pick = victim->assigned_count;
+        int pick_distance = 0;
+        for (size_t j = i; j < victim->assigned_count; ++j) {
+            int type_id = state->rescuer_type_ids[victim->assigned_indices[j]];
+            if (type_id < 0 || need[type_id] <= 0) {
+                continue;
+            }
+            int distance = compute_manhattan_distance(&state->rescuer_pool[victim->assigned_indices[j]],
+                                                      target->x,
+                                                      target->y);
+            if (pick == victim->assigned_count || distance < pick_distance) {
+                pick = j;
+                pick_distance = distance;
+            }
+        }
+        if (pick == victim->assigned_count) {
+            break;
+        }
+
+        int idx = victim->assigned_indices[pick];
+        victim->assigned_indices[pick] = victim->assigned_indices[i];
+        victim->assigned_indices[i] = idx;
+        --need[state->rescuer_type_ids[idx]];
+        state->rescuer_pool[idx].return_available_at = now;
+        update_rescuer_status_locked(state, idx, RETURNING_TO_BASE, emergency_record_name(victim));
+        ++taken;
+        ++i;
+    }
+    if (taken == 0) {
+        return 0;
+    }
+
+    // The taken units are the first ones; keep the rest.
+    memmove(victim->assigned_indices, victim->assigned_indices + taken, (held - taken) * sizeof(int));
+    victim->assigned_count = held - taken;
+
+    // The completion timer holds the end of the on-scene phase.
+    if (victim->status == IN_PROGRESS && timer_wheel_entry_armed(&victim->phase_timer)) {
+        time_t left = victim->phase_timer.expires - now;
+        victim->manage_time_remaining = left > 0 ? (unsigned int)left : 0;
+    }
+
+    emergency_status_t old_status = victim->status;
+    victim->status = PAUSED;
+    LOG_EMERGENCY_STATUS("RT-PAUSED",
+                         "Emergency '%s' %s -> %s due to higher priority preemption (%zu of %zu rescuers taken)",
+                         emergency_record_name(victim),
+                         old_status == ASSIGNED ? "ASSIGNED" :
+                             old_status == IN_PROGRESS ? "IN_PROGRESS" :
+                                 old_status == PAUSED ? "PAUSED" : "UNKNOWN",
+                         "PAUSED",
+                         taken,
+                         held);
+
+    if (old_status == PAUSED) {
+        // Already queued for its replacements.
+        if (victim->assigned_count == 0) {
+            active_list_remove_locked(state, victim);
+        }
+    } else {
+        requeue_preempted_emergency_locked(state, victim);
+    }
+    return taken;
+}
+
+// Chooses the active records of a lower priority to take units from so
+// that, with the dispatchable ones, the target gets every unit it is
+// missing. The unit counts of the preemption index rule out a hopeless
+// target before any record is looked at. Victims are taken from the lowest
+// level first; within a level, the one at the head of an emergency type's
+// list that holds most of what is still missing (fewest units on a tie).
+// A victim whose units turn out not to be needed once the later ones are
+// in is dropped again, so the plan has no redundant victim. Returns the
+// number of victims, listed in preempt_victims, or 0 when no set of
+// victims is enough; preempt_need receives, per type, the units to take
+// from them. Needs mutex and every type lock.
+static size_t preemption_plan_locked(runtime_state_t* state, const emergency_record_t* target) {
+    size_t type_count = state->type_index->rescuer_type_count;
+    size_t kind_count = state->type_index->count;
+    size_t target_level = runtime_priority_level(emergency_effective_priority(target));
+    if (!target->descriptor || target_level == 0) {
+        return 0;
+    }
+
+    long long* need = state->preempt_need;
+    long long* missing = state->preempt_missing;
+    long long* held = state->preempt_held;
+    emergency_record_t** cursor = state->preempt_cursor;
+    emergency_record_t** victims = state->preempt_victims;
+    memset(held, 0, type_count * sizeof(long long));
+
+    bool feasible = true;
+    bool short_of_units = false;
+    for (size_t t = 0; t < type_count && feasible; ++t) {
+        int wanted = record_missing_units(state, target, t);
+        need[t] = wanted > 0 ? wanted - (long long)rescuer_grid_count(&state->available_grid, (int)t) : 0;
+        if (need[t] <= 0) {
+            need[t] = 0;
+            continue;
+        }
+        short_of_units = true;
+        long long freeable = 0;
+        for (size_t level = 0; level < target_level; ++level) {
+            freeable += (long long)state->victim_units[level * type_count + t];
+        }
+        feasible = freeable >= need[t];
+    }
+    if (!feasible || !short_of_units) {
+        return 0;
+    }
+    memcpy(missing, need, type_count * sizeof(long long));
+
+    size_t victim_count = 0;
+    bool covered = false;
+    for (size_t level = 0; level < target_level && !covered; ++level) {
+        memcpy(cursor, &state->victim_lists[level * kind_count], kind_count * sizeof(emergency_record_t*));
+        while (!covered) {
+            size_t best = kind_count;
+            long long best_gain = 0;
+            for (size_t k = 0; k < kind_count; ++k) {
+                if (!cursor[k]) {
+                    continue;
+                }
+                record_count_units(state, cursor[k], held, 1);
+                long long gain = 0;
+                for (size_t t = 0; t < type_count; ++t) {
+                    if (missing[t] > 0 && held[t] > 0) {
+                        gain += held[t] < missing[t] ? held[t] : missing[t];
+                    }
+                }
+                record_count_units(state, cursor[k], held, -1);
+                if (gain > best_gain ||
+                    (gain == best_gain && gain > 0 && cursor[k]->assigned_count < cursor[best]->assigned_count)) {
+                    best = k;
+                    best_gain = gain;
+                }
+            }
+            if (best == kind_count) {
+                break;
+            }
+
+            emergency_record_t* victim = cursor[best];
+            cursor[best] = victim->victim_next;
+            victims[victim_count++] = victim;
+
+            record_count_units(state, victim, missing, -1);
+            covered = true;
+            for (size_t t = 0; t < type_count; ++t) {
+                if (need[t] > 0 && missing[t] > 0) {
+                    covered = false;
+                }
+            }
+        }
+    }
+
+    if (covered) {
+        // Later victims come from higher levels, so they are the first to
+        // give back.
+        for (size_t i = victim_count; i > 0; --i) {
+            record_count_units(state, victims[i - 1], held, 1);
+            bool needed = false;
+            for (size_t t = 0; t < type_count && !needed; ++t) {
+                needed = need[t] > 0 && held[t] > 0 && missing[t] + held[t] > 0;
+            }
+            record_count_units(state, victims[i - 1], held, -1);
+            if (needed) {
+                continue;
+            }
+            record_count_units(state, victims[i - 1], missing, 1);
+            memmove(&victims[i - 1], &victims[i], (victim_count - i) * sizeof(emergency_record_t*));
+            --victim_count;
+        }
+    }
+
+    return covered ? victim_count : 0;
+}
+
+// Frees enough units for target by taking them from lower-priority
+// emergencies: the whole victim set is planned first and applied only if
+// it covers every unit the target is missing, so either the target gets
+// its units or nobody is preempted (short of memory for the allocation
+// itself).
+static bool attempt_preemption_locked(runtime_state_t* state, emergency_record_t* target, size_t* out_count) {
+    if (!state || !target || !out_count) {
         return false;
     }
 
-    const emergency_type_t* type = &record->emergency.type;
-    if (!type->rescuer_requests || type->rescuers_req_number == 0) {
-        *out_indices = NULL;
-        *out_count = 0;
-        return true;
+    if (try_allocate_rescuers_locked(state, target, out_count)) {
+        return true;
+    }
+
+    size_t victim_count = preemption_plan_locked(state, target);
+    if (victim_count == 0) {
+        return false;
+    }
+
+    emergency_record_t** victims = state->preempt_victims;
+    time_t now = runtime_state_now(state);
+    size_t taken = 0;
+    for (size_t i = 0; i < victim_count; ++i) {
+        victim_index_remove_locked(state, victims[i]);
+        taken += preempt_units_locked(state, victims[i], target, state->preempt_need, now);
+        if (victims[i]->active_index != RUNTIME_NOT_ACTIVE && victims[i]->heap_index != WAITING_HEAP_NOT_QUEUED) {
+            victim_index_add_locked(state, victims[i]);
+        }
+    }
+    LOG_EMERGENCY_STATUS("RT-PREEMPT",
+                         "Emergency '%s' takes %zu units from %zu lower-priority emergencies",
+                         emergency_record_name(target),
+                         taken,
+                         victim_count);
+    pthread_cond_broadcast(&state->progress_cond);
+
+    return try_allocate_rescuers_locked(state, target, out_count);
+}
+
+// Status change under the unit's type lock alone; the return timer is
+// left to the caller, who must hold mutex to touch it.
+static void rescuer_set_status_locked(runtime_state_t* state,
+                                      int index,
+                                      rescuer_status_t new_status,
+                                      const char* emergency_name) {
+    rescuer_digital_twin_t* rescuer = &state->rescuer_pool[index];
+    rescuer_status_t old_status = rescuer->status;
+    rescuer->status = new_status;
+    if (new_status == IDLE || new_status == RETURNING_TO_BASE) {
+        rescuer_grid_place(&state->available_grid, index, rescuer);
+    } else {
+        rescuer_grid_remove(&state->available_grid, index);
+    }
+    if (new_status != RETURNING_TO_BASE) {
+        rescuer->return_available_at = 0;
+    }
+    rescore_note_unit_locked(state, index);
+    log_rescuer_transition(rescuer, old_status, new_status, emergency_name);
+}
+
+// Needs mutex and the unit's type lock.
+static void update_rescuer_status_locked(runtime_state_t* state,
+                                         int index,
+                                         rescuer_status_t new_status,
+                                         const char* emergency_name) {
+    if (!state || index < 0 || (size_t)index >= state->rescuer_count) {
+        return;
+    }
+
+    rescuer_set_status_locked(state, index, new_status, emergency_name);
+    rescuer_digital_twin_t* rescuer = &state->rescuer_pool[index];
+    if (new_status == RETURNING_TO_BASE) {
+        time_t due = rescuer->return_available_at != 0 ? rescuer->return_available_at : runtime_state_now(state);
+        runtime_timer_schedule_locked(state, &state->return_timers[index], due);
+    } else {
+        timer_wheel_cancel(&state->return_timers[index]);
+    }
+}
+
+static void update_rescuer_position_locked(runtime_state_t* state, int index, int x, int y) {
+    if (!state || index < 0 || (size_t)index >= state->rescuer_count) {
+        return;
+    }
+    state->rescuer_pool[index].x = x;
+    state->rescuer_pool[index].y = y;
+    rescore_note_unit_locked(state, index);
+    if (rescuer_grid_contains(&state->available_grid, index)) {
+        rescuer_grid_place(&state->available_grid, index, &state->rescuer_pool[index]);
+    }
+}
+
+static void release_rescuers_locked(runtime_state_t* state, emergency_record_t* record) {
+    runtime_lock_types(state, record->descriptor);
+    for (size_t i = 0; i < record->assigned_count; ++i) {
+        update_rescuer_status_locked(state, record->assigned_indices[i], IDLE, emergency_record_name(record));
+    }
+    runtime_unlock_types(state, record->descriptor);
+}
+
+// Lifecycle of an assigned emergency, one timer per phase:
+//   ASSIGNED    --(slowest rescuer arrives)-->     IN_PROGRESS
+//   IN_PROGRESS --(manage_time_remaining elapses)--> COMPLETED, rescuers return to base
+// Preemption cancels the phase timer and requeues the emergency.
+static void begin_travel_locked(runtime_state_t* state, emergency_record_t* record, time_t now) {
+    record->travel_started_at = now;
+    unsigned int travel_time = 1;
+    for (size_t i = 0; i < record->assigned_count; ++i) {
+        int rescuer_idx = record->assigned_indices[i];
+        if (rescuer_idx >= 0 && (size_t)rescuer_idx < state->rescuer_count) {
+            unsigned int t = compute_travel_time_seconds(&state->rescuer_pool[rescuer_idx],
+                                                         record->x,
+                                                         record->y);
+            if (t > travel_time) {
+                travel_time = t;
+            }
+        }
+    }
+
+    runtime_timer_schedule_locked(state, &record->phase_timer, now + (time_t)travel_time);
+}
+
+static void on_emergency_arrived_locked(runtime_state_t* state, emergency_record_t* record, time_t now) {
+    runtime_lock_types(state, record->descriptor);
+    for (size_t i = 0; i < record->assigned_count; ++i) {
+        int idx = record->assigned_indices[i];
+        if (state->rescuer_pool[idx].status == ON_SCENE) {
+            continue; // kept on scene through a partial preemption
+        }
+        update_rescuer_position_locked(state, idx, record->x, record->y);
+        update_rescuer_status_locked(state, idx, ON_SCENE, emergency_record_name(record));
+    }
+    runtime_unlock_types(state, record->descriptor);
+
+    emergency_status_t previous_status = record->status;
+    record->status = IN_PROGRESS;
+    if (previous_status == ASSIGNED && record->requested_at != 0) {
+        state->arrivals++;
+        state->arrival_wait_seconds += (long long)(now - record->requested_at);
+    }
+    LOG_EMERGENCY_STATUS("RT-INPROGRESS",
+                         "Emergency '%s' %s -> %s",
+                         emergency_record_name(record),
+                         previous_status == ASSIGNED
+                             ? "ASSIGNED"
+                             : previous_status == PAUSED ? "PAUSED" :
+                                   previous_status == IN_PROGRESS ? "IN_PROGRESS" : "UNKNOWN",
+                         "IN_PROGRESS");
+
+    runtime_timer_schedule_locked(state, &record->phase_timer, now + (time_t)record->manage_time_remaining);
+}
+
+// Sends every unit the record holds back to base from where it stands.
+// Needs mutex and the record's type locks.
+static void send_units_home_locked(runtime_state_t* state, emergency_record_t* record, time_t now) {
+    for (size_t i = 0; i < record->assigned_count; ++i) {
+        int idx = record->assigned_indices[i];
+        if (idx < 0 || (size_t)idx >= state->rescuer_count) {
+            continue;
+        }
+        rescuer_digital_twin_t* rescuer = &state->rescuer_pool[idx];
+        unsigned int return_time = 0;
+        if (rescuer->type) {
+            return_time = compute_travel_time_seconds(rescuer, rescuer->type->x, rescuer->type->y);
+        }
+        rescuer->return_available_at = now + (time_t)return_time;
+        update_rescuer_status_locked(state, idx, RETURNING_TO_BASE, emergency_record_name(record));
+    }
+}
+
+static void on_emergency_completed_locked(runtime_state_t* state, emergency_record_t* record, time_t now) {
+    runtime_lock_types(state, record->descriptor);
+    send_units_home_locked(state, record, now);
+    runtime_unlock_types(state, record->descriptor);
+
+    record->manage_time_remaining = 0;
+    emergency_status_t previous_status = record->status;
+    record->status = COMPLETED;
+    LOG_EMERGENCY_STATUS("RT-COMPLETED",
+                         "Emergency '%s' %s -> %s",
+                         emergency_record_name(record),
+                         previous_status == IN_PROGRESS
+                             ? "IN_PROGRESS"
+                             : previous_status == ASSIGNED ? "ASSIGNED" :
+                                   previous_status == PAUSED ? "PAUSED" : "UNKNOWN",
+                         "COMPLETED");
+
+    wake_record_waiters_locked(state, record);
+    pthread_cond_broadcast(&state->progress_cond);
+    active_list_remove_locked(state, record);
+    emergency_record_destroy(state, record);
+}
+
+static void on_emergency_phase_locked(runtime_state_t* state, emergency_record_t* record, time_t now) {
+    if (record->status == ASSIGNED) {
+        on_emergency_arrived_locked(state, record, now);
+    } else if (record->status == IN_PROGRESS) {
+        on_emergency_completed_locked(state, record, now);
+    }
+}
+
+// Marks freshly allocated units EN_ROUTE_TO_SCENE; needs their type locks.
+static void claim_rescuers_locked(runtime_state_t* state,
+                                  const emergency_record_t* record,
+                                  const int* indices,
+                                  size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        rescuer_set_status_locked(state, indices[i], EN_ROUTE_TO_SCENE, emergency_record_name(record));
     }
+}
 
-    size_t total_needed = 0;
-    for (int i = 0; i < type->rescuers_req_number; ++i) {
-        if (type->rescuer_requests[i].required_count > 0) {
-            total_needed += (size_t)type->rescuer_requests[i].required_count;
+// Hands a record taken off the waiting queue the added units selected for
+// it, already claimed and written after the ones it holds, and starts its
+// travel; with no rescuers needed it completes right away. A record that
+// kept units through a partial preemption goes on with those too. Needs
+// mutex only; the record's lifecycle steps go to worker owner.
+static void runtime_assign_record_locked(runtime_state_t* state,
+                                         emergency_record_t* record,
+                                         size_t added,
+                                         size_t owner) {
+    record->owner_worker = owner;
+    record->assigned_count += added;
+    size_t assigned_count = record->assigned_count;
+    const int* assigned_indices = record->assigned_indices;
+
+    if (record->timer_started_at != 0) {
+        time_t waited = runtime_state_now(state) - record->timer_started_at;
+        size_t bucket = waited > 0 ? (size_t)waited : 0;
+        ++state->wait_histogram[bucket < RUNTIME_WAIT_BUCKETS ? bucket : RUNTIME_WAIT_BUCKETS - 1];
+        ++state->wait_samples;
+    }
+    emergency_timer_stop(record);
+
+    for (size_t i = 0; i < assigned_count; ++i) {
+        int idx = assigned_indices[i];
+        if (idx < 0 || (size_t)idx >= state->rescuer_count) {
+            continue;
         }
+        // Claimed under its type lock; a unit taken while returning to base
+        // still has its return timer armed.
+        timer_wheel_cancel(&state->return_timers[idx]);
     }
 
-    if (total_needed == 0) {
-        *out_indices = NULL;
-        *out_count = 0;
-        return true;
+    if (assigned_count == 0) {
+        emergency_status_t completed_prev = record->status;
+        record->status = COMPLETED;
+        LOG_EMERGENCY_STATUS("RT-COMPLETED",
+                             "Emergency '%s' %s -> %s",
+                             emergency_record_name(record),
+                             completed_prev == WAITING
+                                 ? "WAITING"
+                                 : completed_prev == PAUSED ? "PAUSED" : "UNKNOWN",
+                             "COMPLETED");
+        pthread_cond_broadcast(&state->progress_cond);
+        emergency_record_destroy(state, record);
+        return;
     }
 
-    int* selections = calloc(total_needed, sizeof(int));
-    if (!selections) {
-        return false;
+    emergency_status_t previous_status = record->status;
+    record->status = ASSIGNED;
+    LOG_EMERGENCY_STATUS("RT-ASSIGNED",
+                         "Emergency '%s' %s -> %s (%zu rescuers)",
+                         emergency_record_name(record),
+                         previous_status == WAITING
+                             ? "WAITING"
+                             : previous_status == PAUSED ? "PAUSED" : "UNKNOWN",
+                         "ASSIGNED",
+                         assigned_count);
+
+    if (record->active_index != RUNTIME_NOT_ACTIVE) {
+        victim_index_add_locked(state, record);
+    } else if (active_list_add_locked(state, record) != 0) {
+        release_rescuers_locked(state, record);
+        wake_record_waiters_locked(state, record);
+        emergency_record_destroy(state, record);
+        return;
     }
 
-    size_t selection_index = 0;
+    // From here on the emergency advances through timer events; the worker
+    // goes straight back to the queue.
+    begin_travel_locked(state, record, runtime_state_now(state));
+}
+
+// Serves the record at the head of the waiting queue. Returns 1 once it
+// has been assigned (or completed with no rescuers needed), 0 if the queue
+// is empty and -1 if no rescuers could be found, in which case the record
+// is back in the queue. owner is the dispatching worker.
+//
+// Called with mutex held, which is dropped while the record's own type
+// locks are held for the allocation; the record is off the queue and out
+// of the preemption index, so nothing else can reach it meanwhile. Only when that fails
+// does it fall back to preemption, under mutex and every type lock.
+static int runtime_dispatch_next_locked(runtime_state_t* state, size_t owner) {
+    runtime_rescore_waiting_locked(state);
+    emergency_record_t* record = waiting_queue_pop_front_locked(state);
+    if (!record) {
+        return 0;
+    }
 
-    time_t now = time(NULL);
+    size_t added = 0;
+    pthread_mutex_unlock(&state->mutex);
+    runtime_lock_types(state, record->descriptor);
+    bool allocated = try_allocate_rescuers_locked(state, record, &added);
+    if (allocated) {
+        claim_rescuers_locked(state, record, record->assigned_indices + record->assigned_count, added);
+    }
+    runtime_unlock_types(state, record->descriptor);
+    pthread_mutex_lock(&state->mutex);
 
-    for (int req_idx = 0; req_idx < type->rescuers_req_number; ++req_idx) {
-        const rescuer_request_t* req = &type->rescuer_requests[req_idx];
-        if (!req->type || req->required_count <= 0) {
-            continue;
+    if (!allocated) {
+        runtime_lock_all_types(state);
+        allocated = attempt_preemption_locked(state, record, &added);
+        if (allocated) {
+            claim_rescuers_locked(state, record, record->assigned_indices + record->assigned_count, added);
         }
+        runtime_unlock_all_types(state);
+    }
+    if (!allocated) {
+        waiting_queue_insert_locked(state, record);
+        return -1;
+    }
 
-        for (int needed = 0; needed < req->required_count; ++needed) {
-            int best_index = -1;
-            int best_distance = INT_MAX;
-            for (size_t rescuer_idx = 0; rescuer_idx < state->rescuer_count; ++rescuer_idx) {
-                rescuer_digital_twin_t* rescuer = &state->rescuer_pool[rescuer_idx];
-                if (rescuer->status != IDLE && rescuer->status != RETURNING_TO_BASE) {
-                    continue;
-                }
-                if (rescuer->type != req->type) {
-                    continue;
-                }
+    runtime_assign_record_locked(state, record, added, owner);
+    return 1;
+}
 
-                bool already_selected = false;
-                for (size_t check = 0; check < selection_index; ++check) {
-                    if (selections[check] == (int)rescuer_idx) {
-                        already_selected = true;
-                        break;
-                    }
-                }
-                if (already_selected) {
-                    continue;
-                }
+typedef struct runtime_batch_candidate_t {
+    long long cost;
+    int index;
+} runtime_batch_candidate_t;
 
-                int distance = compute_manhattan_distance(rescuer, record->emergency.x, record->emergency.y);
-                if (rescuer->status == RETURNING_TO_BASE && rescuer->return_available_at > now &&
-                    rescuer->return_available_at != 0) {
-                    time_t delta = rescuer->return_available_at - now;
-                    if (delta > 0) {
-                        distance += (int)delta;
-                    }
-                }
-                if (distance < best_distance) {
-                    best_distance = distance;
-                    best_index = (int)rescuer_idx;
-                }
-            }
+static bool batch_candidate_less(const runtime_batch_candidate_t* a, const runtime_batch_candidate_t* b) {
+    return a->cost < b->cost || (a->cost == b->cost && a->index < b->index);
+}
 
-            if (best_index < 0) {
-                free(selections);
-                return false;
-            }
+static int batch_index_compare(const void* lhs, const void* rhs) {
+    int a = *(const int*)lhs;
+    int b = *(const int*)rhs;
+    return (a > b) - (a < b);
+}
 
-            selections[selection_index++] = best_index;
-        }
+// One dispatch round: the records taken off the queue, the dispatchable
+// units grouped by type (by index within a type) and, per record, the
+// units picked for it so far. Its buffers outlive the round: all but the
+// cost matrix are sized at start, the matrix grows on demand.
+typedef struct runtime_batch_t {
+    emergency_record_t* records[RUNTIME_BATCH_MAX];
+    int* picks[RUNTIME_BATCH_MAX]; // after the units the record holds, in its slab object
+    size_t pick_count[RUNTIME_BATCH_MAX];
+    size_t record_count;
+    long long total_cost;
+    int* candidates;            // per rescuer
+    size_t* type_start;         // rescuer_type_count + 1 offsets into candidates
+    size_t* free_units;         // per rescuer type, while the prefix is taken
+    unsigned char* taken;       // per rescuer: assigned in this round
+    unsigned char* in_columns;  // per rescuer: column of the current matrix
+    int* columns;               // per rescuer
+    runtime_batch_candidate_t* nearest; // RUNTIME_BATCH_MAX * record_units
+    int* row_to_col;                    // RUNTIME_BATCH_MAX * record_units
+    long long* cost;
+    size_t cost_capacity;
+} runtime_batch_t;
+
+static void runtime_batch_free(runtime_state_t* state) {
+    runtime_batch_t* batch = state->batch;
+    if (!batch) {
+        return;
     }
 
-    *out_indices = selections;
-    *out_count = selection_index;
-    return true;
+    free(batch->candidates);
+    free(batch->type_start);
+    free(batch->free_units);
+    free(batch->taken);
+    free(batch->in_columns);
+    free(batch->columns);
+    free(batch->nearest);
+    free(batch->row_to_col);
+    free(batch->cost);
+    free(batch);
+    state->batch = NULL;
 }
 
-static bool attempt_preemption_locked(runtime_state_t* state,
-                                      emergency_record_t* target,
-                                      int** out_indices,
-                                      size_t* out_count) {
-    if (!state || !target || !out_indices || !out_count) {
-        return false;
+static int runtime_batch_create(runtime_state_t* state) {
+    size_t type_count = state->type_index->rescuer_type_count;
+    size_t rescuers = state->rescuer_count ? state->rescuer_count : 1;
+    size_t slots = RUNTIME_BATCH_MAX * (state->record_units ? state->record_units : 1);
+    runtime_batch_t* batch = calloc(1, sizeof(*batch));
+    if (!batch) {
+        return -1;
+    }
+    state->batch = batch;
+
+    batch->candidates = malloc(rescuers * sizeof(int));
+    batch->type_start = calloc(type_count + 1, sizeof(size_t));
+    batch->free_units = calloc(type_count ? type_count : 1, sizeof(size_t));
+    batch->taken = calloc(rescuers, 1);
+    batch->in_columns = calloc(rescuers, 1);
+    batch->columns = malloc(rescuers * sizeof(int));
+    batch->nearest = malloc(slots * sizeof(runtime_batch_candidate_t));
+    batch->row_to_col = malloc(slots * sizeof(int));
+    if (!batch->candidates || !batch->type_start || !batch->free_units || !batch->taken || !batch->in_columns ||
+        !batch->columns || !batch->nearest || !batch->row_to_col) {
+        runtime_batch_free(state);
+        return -1;
     }
+    return 0;
+}
 
-    short target_priority = emergency_effective_priority(target);
+static int batch_demand(const runtime_state_t* state, const emergency_record_t* record, size_t type_id) {
+    return record_missing_units(state, record, type_id);
+}
 
-    while (true) {
-        if (try_allocate_rescuers_locked(state, target, out_indices, out_count)) {
-            return true;
-        }
+// Travel time in milliseconds from a unit to (x, y). A returning unit is
+// charged the seconds it still needs as extra distance, the same score
+// rescuer_grid_nearest() ranks units by.
+static long long batch_cost_locked(const runtime_state_t* state, int index, int x, int y, time_t now) {
+    const rescuer_digital_twin_t* rescuer = &state->rescuer_pool[index];
+    long long speed = rescuer->type && rescuer->type->speed > 0 ? rescuer->type->speed : 1;
+    return rescuer_grid_score(rescuer, x, y, now) * 1000 / speed;
+}
 
-        emergency_record_t* best_candidate = NULL;
-        size_t best_index = 0;
+// Assigns the units of one type to records [first, last), all of the same
+// priority, at minimum total cost. Each record only needs its `slots`
+// cheapest free units as columns (slots = the level's total demand for the
+// type): if an optimal assignment used a dearer one, one of those would be
+// free and no worse. The caller has checked that enough units are free.
+static int batch_assign_type_locked(runtime_state_t* state,
+                                    runtime_batch_t* batch,
+                                    size_t first,
+                                    size_t last,
+                                    size_t type_id,
+                                    time_t now) {
+    size_t slots = 0;
+    for (size_t r = first; r < last; ++r) {
+        slots += (size_t)batch_demand(state, batch->records[r], type_id);
+    }
+    if (slots == 0) {
+        return 0;
+    }
 
-        for (size_t i = 0; i < state->active_count; ++i) {
-            emergency_record_t* candidate = state->active_emergencies[i];
-            if (!candidate || candidate->preempted) {
-                continue;
-            }
+    size_t begin = batch->type_start[type_id];
+    size_t end = batch->type_start[type_id + 1];
+    runtime_batch_candidate_t* nearest = batch->nearest;
+    int* columns = batch->columns;
+    size_t column_count = 0;
+    for (size_t r = first; r < last; ++r) {
+        const emergency_record_t* record = batch->records[r];
+        if (batch_demand(state, record, type_id) <= 0) {
+            continue;
+        }
 
-            if (candidate->assigned_count == 0) {
+        // Keep the `slots` cheapest free units, sorted, by insertion.
+        size_t kept = 0;
+        for (size_t c = begin; c < end; ++c) {
+            int idx = batch->candidates[c];
+            if (batch->taken[idx]) {
                 continue;
             }
-
-            short candidate_priority = emergency_effective_priority(candidate);
-            if (candidate_priority >= target_priority) {
+            runtime_batch_candidate_t candidate = {
+                .cost = batch_cost_locked(state, idx, record->x, record->y, now),
+                .index = idx,
+            };
+            if (kept == slots && !batch_candidate_less(&candidate, &nearest[kept - 1])) {
                 continue;
             }
-
-            bool eligible = true;
-            for (size_t j = 0; j < candidate->assigned_count; ++j) {
-                int idx = candidate->assigned_indices[j];
-                if (idx < 0 || (size_t)idx >= state->rescuer_count) {
-                    continue;
-                }
-                rescuer_status_t status = state->rescuer_pool[idx].status;
-                if (status != EN_ROUTE_TO_SCENE && status != ON_SCENE) {
-                    eligible = false;
-                    break;
-                }
+            size_t pos = kept < slots ? kept++ : kept - 1;
+            while (pos > 0 && batch_candidate_less(&candidate, &nearest[pos - 1])) {
+                nearest[pos] = nearest[pos - 1];
+                --pos;
             }
-
-            if (!eligible) {
-                continue;
+            nearest[pos] = candidate;
+        }
+        for (size_t c = 0; c < kept; ++c) {
+            if (!batch->in_columns[nearest[c].index]) {
+                batch->in_columns[nearest[c].index] = 1;
+                columns[column_count++] = nearest[c].index;
             }
+        }
+    }
+    for (size_t c = 0; c < column_count; ++c) {
+        batch->in_columns[columns[c]] = 0;
+    }
+    qsort(columns, column_count, sizeof(int), batch_index_compare);
 
-            if (!best_candidate) {
-                best_candidate = candidate;
-                best_index = i;
-                continue;
+    if (slots * column_count > batch->cost_capacity) {
+        long long* grown = realloc(batch->cost, slots * column_count * sizeof(long long));
+        if (!grown) {
+            return -1;
+        }
+        batch->cost = grown;
+        batch->cost_capacity = slots * column_count;
+    }
+    long long* cost = batch->cost;
+    size_t row = 0;
+    for (size_t r = first; r < last; ++r) {
+        const emergency_record_t* record = batch->records[r];
+        for (int unit = 0; unit < batch_demand(state, record, type_id); ++unit, ++row) {
+            for (size_t c = 0; c < column_count; ++c) {
+                cost[row * column_count + c] =
+                    batch_cost_locked(state, columns[c], record->x, record->y, now);
             }
+        }
+    }
 
-            short best_priority = emergency_effective_priority(best_candidate);
-            if (candidate_priority < best_priority) {
-                best_candidate = candidate;
-                best_index = i;
-                continue;
-            }
+    long long total = 0;
+    int* row_to_col = batch->row_to_col;
+    if (assignment_solve(&state->batch_solver, cost, slots, column_count, row_to_col, &total) != 0) {
+        return -1;
+    }
+    batch->total_cost += total;
 
-            if (candidate_priority == best_priority &&
-                candidate->priority_score < best_candidate->priority_score) {
-                best_candidate = candidate;
-                best_index = i;
-            }
+    row = 0;
+    for (size_t r = first; r < last; ++r) {
+        for (int unit = 0; unit < batch_demand(state, batch->records[r], type_id); ++unit, ++row) {
+            int idx = columns[row_to_col[row]];
+            batch->taken[idx] = 1;
+            batch->picks[r][batch->pick_count[r]++] = idx;
         }
+    }
+    return 0;
+}
 
-        if (!best_candidate) {
+static bool batch_record_fits(const runtime_state_t* state, const emergency_record_t* record, const size_t* free_units) {
+    for (size_t t = 0; t < state->type_index->rescuer_type_count; ++t) {
+        int demand = batch_demand(state, record, t);
+        if (demand > 0 && (size_t)demand > free_units[t]) {
             return false;
         }
+    }
+    return true;
+}
 
-        time_t now = time(NULL);
-        for (size_t j = 0; j < best_candidate->assigned_count; ++j) {
-            int idx = best_candidate->assigned_indices[j];
-            if (idx < 0 || (size_t)idx >= state->rescuer_count) {
-                continue;
+// Takes off the queue the longest prefix (up to RUNTIME_BATCH_MAX records)
+// whose demand the free units can cover together, so nothing overtakes a
+// record that has to wait or preempt.
+static void batch_take_prefix_locked(runtime_state_t* state, runtime_batch_t* batch) {
+    size_t type_count = state->type_index->rescuer_type_count;
+    size_t* free_units = batch->free_units;
+    for (size_t t = 0; t < type_count; ++t) {
+        free_units[t] = rescuer_grid_count(&state->available_grid, (int)t);
+    }
+
+    time_t now = runtime_state_now(state);
+    while (batch->record_count < RUNTIME_BATCH_MAX) {
+        emergency_record_t* record = runtime_waiting_head_locked(state, now);
+        if (!record || !batch_record_fits(state, record, free_units)) {
+            break;
+        }
+        for (size_t t = 0; t < type_count; ++t) {
+            int demand = batch_demand(state, record, t);
+            if (demand > 0) {
+                free_units[t] -= (size_t)demand;
             }
-            rescuer_digital_twin_t* rescuer = &state->rescuer_pool[idx];
-            rescuer->return_available_at = now;
-            update_rescuer_status_locked(state, idx, RETURNING_TO_BASE, best_candidate->emergency.name);
         }
-        pthread_cond_broadcast(&state->rescuer_available_cond);
+        waiting_queue_pop_front_locked(state);
+        batch->picks[batch->record_count] = record->assigned_indices + record->assigned_count;
+        batch->pick_count[batch->record_count] = 0;
+        batch->records[batch->record_count++] = record;
+    }
+}
 
-        free(best_candidate->assigned_indices);
-        best_candidate->assigned_indices = NULL;
-        best_candidate->assigned_count = 0;
+// Groups the dispatchable units by type, in index order.
+static void batch_collect_candidates_locked(runtime_state_t* state, runtime_batch_t* batch) {
+    size_t type_count = state->type_index->rescuer_type_count;
+    memset(batch->taken, 0, state->rescuer_count);
+    for (size_t t = 0; t < type_count; ++t) {
+        batch->type_start[t + 1] = batch->type_start[t] + rescuer_grid_count(&state->available_grid, (int)t);
+    }
+    // type_start[t + 1] becomes the fill cursor of type t and ends up back
+    // at the type's end offset.
+    for (size_t t = type_count; t > 0; --t) {
+        batch->type_start[t] = batch->type_start[t - 1];
+    }
 
-        if (best_candidate->emergency.rescuers_dt) {
-            free(best_candidate->emergency.rescuers_dt);
-            best_candidate->emergency.rescuers_dt = NULL;
+    for (size_t i = 0; i < state->rescuer_count; ++i) {
+        rescuer_status_t status = state->rescuer_pool[i].status;
+        int type_id = state->rescuer_type_ids[i];
+        if (type_id >= 0 && (status == IDLE || status == RETURNING_TO_BASE)) {
+            batch->candidates[batch->type_start[type_id + 1]++] = (int)i;
         }
+    }
+}
 
-        emergency_status_t old_status = best_candidate->emergency.status;
-        best_candidate->emergency.status = PAUSED;
-        if (old_status != PAUSED) {
-            LOG_EMERGENCY_STATUS("RT-PAUSED",
-                                 "Emergency '%s' %s -> %s due to higher priority preemption",
-                                 best_candidate->emergency.name,
-                                 old_status == ASSIGNED ? "ASSIGNED" :
-                                     old_status == IN_PROGRESS ? "IN_PROGRESS" :
-                                         old_status == WAITING ? "WAITING" :
-                                             old_status == COMPLETED ? "COMPLETED" :
-                                                 old_status == PAUSED ? "PAUSED" : "UNKNOWN",
-                                 "PAUSED");
-        }
+static double batch_elapsed_ms(const struct timespec* start, const struct timespec* end) {
+    return (double)(end->tv_sec - start->tv_sec) * 1e3 + (double)(end->tv_nsec - start->tv_nsec) / 1e6;
+}
 
-        best_candidate->preempted = true;
-        update_record_priority_locked(state, best_candidate);
+// Batched dispatch round. Takes the fitting prefix of the waiting queue and
+// assigns it one priority level at a time, highest first, each level at
+// minimum total travel time over the units the levels above left. Holds
+// every type lock until the units are claimed; owner is the worker
+// running the round. Returns the number of records served; whatever is
+// left is for runtime_dispatch_next_locked().
+static size_t runtime_dispatch_batch_locked(runtime_state_t* state, size_t owner) {
+    runtime_batch_t* batch = state->batch;
+    if (!batch) {
+        return 0;
+    }
+    batch->record_count = 0;
+    batch->total_cost = 0;
+
+    struct timespec started;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+
+    size_t solved = 0; // records [0, solved) have claimed their units
+    size_t served = 0;
+    size_t units = 0;
+    double solver_ms = 0.0;
+    runtime_rescore_waiting_locked(state);
+    runtime_lock_all_types(state);
+    batch_take_prefix_locked(state, batch);
+    if (batch->record_count > 0) {
+        batch_collect_candidates_locked(state, batch);
+        size_t type_count = state->type_index->rescuer_type_count;
+        time_t now = runtime_state_now(state);
+        while (solved < batch->record_count) {
+            short priority = emergency_effective_priority(batch->records[solved]);
+            size_t level_end = solved + 1;
+            while (level_end < batch->record_count &&
+                   emergency_effective_priority(batch->records[level_end]) == priority) {
+                ++level_end;
+            }
 
-        pthread_cond_broadcast(&state->progress_cond);
+            struct timespec solve_start;
+            struct timespec solve_end;
+            clock_gettime(CLOCK_MONOTONIC, &solve_start);
+            int rc = 0;
+            for (size_t t = 0; t < type_count && rc == 0; ++t) {
+                rc = batch_assign_type_locked(state, batch, solved, level_end, t, now);
+            }
+            clock_gettime(CLOCK_MONOTONIC, &solve_end);
+            solver_ms += batch_elapsed_ms(&solve_start, &solve_end);
+            if (rc != 0) {
+                break;
+            }
 
-        (void)best_index;
+            for (size_t r = solved; r < level_end; ++r) {
+                claim_rescuers_locked(state, batch->records[r], batch->picks[r], batch->pick_count[r]);
+            }
+            solved = level_end;
+        }
     }
-}
+    runtime_unlock_all_types(state);
 
-static void requeue_preempted_emergency_locked(runtime_state_t* state,
-                                               emergency_record_t* record) {
-    if (!state || !record) {
-        return;
+    for (size_t r = 0; r < solved; ++r) {
+        units += batch->pick_count[r];
+        runtime_assign_record_locked(state, batch->records[r], batch->pick_count[r], owner);
+        ++served;
     }
 
-    ssize_t idx = active_list_find_index_locked(state, record);
-    if (idx >= 0) {
-        active_list_remove_index_locked(state, (size_t)idx);
+    // Only an allocation failure leaves records behind; they go back to
+    // the queue for the one-by-one path.
+    for (size_t r = served; r < batch->record_count; ++r) {
+        waiting_queue_insert_locked(state, batch->records[r]);
     }
 
-    free(record->assigned_indices);
-    record->assigned_indices = NULL;
-    record->assigned_count = 0;
-    update_record_priority_locked(state, record);
-    record->preempted = false;
-    emergency_timer_start(state, record);
-    waiting_queue_insert_locked(state, record);
-    pthread_cond_signal(&state->emergency_available_cond);
+    if (batch->record_count > 0) {
+        struct timespec finished;
+        clock_gettime(CLOCK_MONOTONIC, &finished);
+        LOG_SYSTEM("RT-BATCH",
+                   "Batch round: %zu emergencies, %zu rescuers, travel cost %lld ms, solver %.3f ms, round %.3f ms, %zu still waiting",
+                   served,
+                   units,
+                   batch->total_cost,
+                   solver_ms,
+                   batch_elapsed_ms(&started, &finished),
+                   waiting_heap_count(&state->waiting));
+    }
+
+    return served;
 }
 
-static void update_rescuer_status_locked(runtime_state_t* state,
-                                         int index,
-                                         rescuer_status_t new_status,
-                                         const char* emergency_name) {
-    if (!state || index < 0 || (size_t)index >= state->rescuer_count) {
-        return;
-    }
+// Lets arrivals pile up in the waiting queue for batch_window_ms before a
+// batched round; the other workers stay parked while batch_collecting is
+// set, and steps queued on this worker meanwhile go to them.
+static void runtime_collect_batch_locked(runtime_state_t* state, runtime_worker_t* worker) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += (time_t)(state->batch_window_ms / 1000);
+    deadline.tv_nsec += (long)(state->batch_window_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    state->batch_collecting = true;
+    while (!state->shutdown_requested &&
+           pthread_cond_timedwait(&worker->wake, &state->mutex, &deadline) != ETIMEDOUT) {
+    }
+    ingest_splice_locked(state);
+    state->batch_collecting = false;
+}
 
-    rescuer_digital_twin_t* rescuer = &state->rescuer_pool[index];
-    rescuer_status_t old_status = rescuer->status;
-    rescuer->status = new_status;
-    if (new_status != RETURNING_TO_BASE) {
-        rescuer->return_available_at = 0;
+static void* runtime_monitor_thread(void* arg) {
+    runtime_state_t* state = (runtime_state_t*)arg;
+    if (!state) {
+        return NULL;
     }
-    log_rescuer_transition(rescuer, old_status, new_status, emergency_name);
-}
 
-static void update_rescuer_position_locked(runtime_state_t* state, int index, int x, int y) {
-    if (!state || index < 0 || (size_t)index >= state->rescuer_count) {
-        return;
+    pthread_mutex_lock(&state->mutex);
+    while (!state->shutdown_requested) {
+        runtime_fire_timers_locked(state, runtime_state_now(state));
+
+        time_t next;
+        if (timer_wheel_next_expiry(&state->timers, &next)) {
+            state->monitor_wake_at = next;
+            runtime_clock_wait_until(state->clock, &state->timer_cond, &state->mutex, next);
+        } else {
+            state->monitor_wake_at = 0;
+            pthread_cond_wait(&state->timer_cond, &state->mutex);
+        }
     }
-    state->rescuer_pool[index].x = x;
-    state->rescuer_pool[index].y = y;
+    pthread_mutex_unlock(&state->mutex);
+
+    runtime_state_release_thread_cache(state);
+    return NULL;
 }
 
-static void* runtime_monitor_thread(void* arg) {
+static void* runtime_ingest_thread(void* arg) {
     runtime_state_t* state = (runtime_state_t*)arg;
     if (!state) {
         return NULL;
     }
 
     while (true) {
+        while (sem_wait(&state->ingest_doorbell) != 0 && errno == EINTR) {
+        }
+
         pthread_mutex_lock(&state->mutex);
         if (state->shutdown_requested) {
             pthread_mutex_unlock(&state->mutex);
             break;
         }
-        time_t now = time(NULL);
-        monitor_waiting_queue_locked(state, now);
-        monitor_returning_rescuers_locked(state, now);
+        ingest_splice_locked(state);
         pthread_mutex_unlock(&state->mutex);
-        sleep(1);
     }
 
     return NULL;
 }
 
+// Takes the oldest step queued on another worker, starting from the next
+// one along so thieves spread over the pool.
+static timer_wheel_entry_t* runtime_steal_step_locked(runtime_state_t* state, const runtime_worker_t* thief) {
+    for (size_t offset = 1; offset < state->worker_count; ++offset) {
+        runtime_worker_t* victim = &state->workers[(thief->id + offset) % state->worker_count];
+        timer_wheel_entry_t* step = timer_wheel_list_pop_front(&victim->steps);
+        if (step) {
+            return step;
+        }
+    }
+    return NULL;
+}
+
+// Closes a wakeup for freed units once the worker has been back to the
+// queue; dispatched tells whether it found anything to serve.
+static void worker_settle_wakeup(runtime_worker_t* worker, bool dispatched) {
+    if (!worker->units_woken) {
+        return;
+    }
+    worker->units_woken = false;
+    ++worker->unit_wakeups;
+    if (!dispatched) {
+        ++worker->spurious_wakeups;
+    }
+}
+
+// Parks worker in the wait channels of the types the head of the queue is
+// short of, keying every parked worker on that head. Returns false when it
+// is short of nothing: units came back while the dispatch had mutex
+// dropped, so the worker looks again instead of parking.
+static bool rescuer_wait_register_locked(runtime_state_t* state, runtime_worker_t* worker) {
+    const emergency_record_t* head = waiting_heap_peek(&state->waiting);
+    if (!head) {
+        return false;
+    }
+
+    worker->waiting_rescuers = true;
+    ++state->rescuer_wait_count;
+    if (!rescuer_wait_key_locked(state, head)) {
+        rescuer_wait_unlist_locked(state, worker);
+        return false;
+    }
+    return true;
+}
+
+// Order of work: the worker's own steps, newest first; then the waiting
+// heap; then steps stolen from the others. A step can free units, so it
+// also clears a previous failure to find rescuers.
 static void* runtime_worker_thread(void* arg) {
-    runtime_state_t* state = (runtime_state_t*)arg;
-    if (!state) {
+    runtime_worker_t* worker = (runtime_worker_t*)arg;
+    if (!worker || !worker->state) {
         return NULL;
     }
+    runtime_state_t* state = worker->state;
+    bool blocked = false;
 
     while (true) {
         pthread_mutex_lock(&state->mutex);
-        while (!state->shutdown_requested && state->waiting_count == 0) {
-            pthread_cond_wait(&state->emergency_available_cond, &state->mutex);
-        }
-
+        ingest_splice_locked(state);
         if (state->shutdown_requested) {
             pthread_mutex_unlock(&state->mutex);
             break;
         }
-
-        emergency_record_t* record = waiting_queue_pop_front_locked(state);
-        if (!record) {
+        if (worker->retiring) {
+            runtime_worker_retire_locked(state, worker);
             pthread_mutex_unlock(&state->mutex);
-            continue;
+            break;
         }
 
-        record->preempted = false;
-
-        int* assigned_indices = NULL;
-        size_t assigned_count = 0;
-        if (!try_allocate_rescuers_locked(state, record, &assigned_indices, &assigned_count) &&
-            !attempt_preemption_locked(state, record, &assigned_indices, &assigned_count)) {
-            waiting_queue_insert_locked(state, record);
-            pthread_cond_wait(&state->rescuer_available_cond, &state->mutex);
+        timer_wheel_entry_t* step = timer_wheel_list_pop_back(&worker->steps);
+        if (step) {
+            ++worker->steps_run;
+            runtime_timer_fired_locked(state, step, runtime_state_now(state));
+            blocked = false;
             pthread_mutex_unlock(&state->mutex);
             continue;
         }
 
-        record->assigned_indices = assigned_indices;
-        record->assigned_count = assigned_count;
-
-        free(record->emergency.rescuers_dt);
-        record->emergency.rescuers_dt = NULL;
-        record->emergency.rescuer_count = (int)assigned_count;
-        if (assigned_count > 0) {
-            record->emergency.rescuers_dt =
-                calloc((size_t)assigned_count, sizeof(rescuer_digital_twin_t));
-        }
-
-        emergency_timer_stop(record);
-
-        for (size_t i = 0; i < assigned_count; ++i) {
-            int idx = assigned_indices[i];
-            if (idx < 0 || (size_t)idx >= state->rescuer_count) {
-                continue;
+        if (!blocked && !state->batch_collecting && waiting_heap_count(&state->waiting) > 0) {
+            size_t dispatched = worker->dispatched;
+            if (state->batch_window_ms > 0) {
+                runtime_collect_batch_locked(state, worker);
+                worker->dispatched += runtime_dispatch_batch_locked(state, worker->id);
             }
-            if (record->emergency.rescuers_dt && (int)i < record->emergency.rescuer_count) {
-                record->emergency.rescuers_dt[i] = state->rescuer_pool[idx];
+            int rc = state->shutdown_requested ? 0 : runtime_dispatch_next_locked(state, worker->id);
+            if (rc > 0) {
+                ++worker->dispatched;
             }
-            update_rescuer_status_locked(state, idx, EN_ROUTE_TO_SCENE, record->emergency.name);
-        }
-
-        if (assigned_count == 0) {
-            emergency_status_t completed_prev = record->emergency.status;
-            record->emergency.status = COMPLETED;
-            LOG_EMERGENCY_STATUS("RT-COMPLETED",
-                                 "Emergency '%s' %s -> %s",
-                                 record->emergency.name,
-                                 completed_prev == WAITING
-                                     ? "WAITING"
-                                     : completed_prev == PAUSED ? "PAUSED" : "UNKNOWN",
-                                 "COMPLETED");
-            pthread_cond_broadcast(&state->progress_cond);
-            pthread_mutex_unlock(&state->mutex);
-            emergency_record_destroy(record);
-            continue;
+            worker_settle_wakeup(worker, worker->dispatched > dispatched);
+            if (rc >= 0) {
+                pthread_mutex_unlock(&state->mutex);
+                continue;
+            }
+            blocked = true;
         }
 
-        emergency_status_t previous_status = record->emergency.status;
-        record->emergency.status = ASSIGNED;
-        LOG_EMERGENCY_STATUS("RT-ASSIGNED",
-                             "Emergency '%s' %s -> %s (%zu rescuers)",
-                             record->emergency.name,
-                             previous_status == WAITING
-                                 ? "WAITING"
-                                 : previous_status == PAUSED ? "PAUSED" : "UNKNOWN",
-                             "ASSIGNED",
-                             assigned_count);
-
-        size_t active_index = active_list_add_locked(state, record);
-        if (active_index == (size_t)-1) {
+        step = runtime_steal_step_locked(state, worker);
+        if (step) {
+            ++worker->steps_run;
+            ++worker->steps_stolen;
+            runtime_timer_fired_locked(state, step, runtime_state_now(state));
+            blocked = false;
             pthread_mutex_unlock(&state->mutex);
             continue;
         }
 
-        pthread_mutex_unlock(&state->mutex);
-
-        unsigned int travel_time = 1;
-        pthread_mutex_lock(&state->mutex);
-        for (size_t i = 0; i < record->assigned_count; ++i) {
-            int rescuer_idx = record->assigned_indices[i];
-            if (rescuer_idx >= 0 && (size_t)rescuer_idx < state->rescuer_count) {
-                unsigned int t = compute_travel_time_seconds(&state->rescuer_pool[rescuer_idx],
-                                                             record->emergency.x,
-                                                             record->emergency.y);
-                if (t > travel_time) {
-                    travel_time = t;
-                }
-            }
-        }
-        pthread_mutex_unlock(&state->mutex);
-
-        for (unsigned int elapsed = 0; elapsed < travel_time; ++elapsed) {
-            pthread_mutex_lock(&state->mutex);
-            if (state->shutdown_requested || record->preempted || record->assigned_count == 0) {
+        if (blocked) {
+            if (!rescuer_wait_register_locked(state, worker)) {
+                blocked = false;
                 pthread_mutex_unlock(&state->mutex);
-                goto worker_cleanup;
+                continue;
             }
-            pthread_mutex_unlock(&state->mutex);
-            sleep(1);
-        }
-
-        pthread_mutex_lock(&state->mutex);
-        if (state->shutdown_requested || record->preempted || record->assigned_count == 0) {
-            pthread_mutex_unlock(&state->mutex);
-            goto worker_cleanup;
+        } else {
+            worker_settle_wakeup(worker, false);
+            worker->idle = true;
+            state->idle_workers[state->idle_count++] = worker->id;
         }
-        for (size_t i = 0; i < record->assigned_count; ++i) {
-            int idx = record->assigned_indices[i];
-            update_rescuer_position_locked(state, idx, record->emergency.x, record->emergency.y);
-            update_rescuer_status_locked(state, idx, ON_SCENE, record->emergency.name);
+        while (!state->shutdown_requested && !worker->retiring && (worker->idle || worker->waiting_rescuers)) {
+            pthread_cond_wait(&worker->wake, &state->mutex);
         }
-        previous_status = record->emergency.status;
-        record->emergency.status = IN_PROGRESS;
-        LOG_EMERGENCY_STATUS("RT-INPROGRESS",
-                             "Emergency '%s' %s -> %s",
-                             record->emergency.name,
-                             previous_status == ASSIGNED
-                                 ? "ASSIGNED"
-                                 : previous_status == PAUSED ? "PAUSED" :
-                                       previous_status == IN_PROGRESS ? "IN_PROGRESS" : "UNKNOWN",
-                             "IN_PROGRESS");
+        blocked = false;
         pthread_mutex_unlock(&state->mutex);
+    }
 
-        while (true) {
-            pthread_mutex_lock(&state->mutex);
-            if (state->shutdown_requested || record->preempted || record->assigned_count == 0) {
-                pthread_mutex_unlock(&state->mutex);
-                goto worker_cleanup;
-            }
-            if (record->manage_time_remaining == 0) {
-                pthread_mutex_unlock(&state->mutex);
-                break;
-            }
-            record->manage_time_remaining--;
-            pthread_mutex_unlock(&state->mutex);
-            sleep(1);
-        }
+    // A retired worker's thread is gone for good; its cached records go
+    // back to the slab.
+    runtime_state_release_thread_cache(state);
+    return NULL;
+}
 
-        pthread_mutex_lock(&state->mutex);
-        if (state->shutdown_requested || record->preempted || record->assigned_count == 0) {
-            pthread_mutex_unlock(&state->mutex);
-            goto worker_cleanup;
+size_t runtime_state_settle(runtime_state_t* state) {
+    if (!state) {
+        return 0;
+    }
+
+    size_t steps = 0;
+    size_t progress;
+    pthread_mutex_lock(&state->mutex);
+    do {
+        progress = ingest_splice_locked(state);
+        progress += runtime_fire_timers_locked(state, runtime_state_now(state));
+        if (state->batch_window_ms > 0) {
+            progress += runtime_dispatch_batch_locked(state, 0);
         }
-        for (size_t i = 0; i < record->assigned_count; ++i) {
-            int idx = record->assigned_indices[i];
-            if (idx < 0 || (size_t)idx >= state->rescuer_count) {
-                continue;
-            }
-            rescuer_digital_twin_t* rescuer = &state->rescuer_pool[idx];
-            unsigned int return_time = travel_time;
-            if (rescuer->type) {
-                return_time = compute_travel_time_seconds(rescuer, rescuer->type->x, rescuer->type->y);
-            }
-            time_t now = time(NULL);
-            if (now != (time_t)-1) {
-                rescuer->return_available_at = now + (time_t)return_time;
-            } else {
-                rescuer->return_available_at = 0;
-            }
-            update_rescuer_status_locked(state, idx, RETURNING_TO_BASE, record->emergency.name);
+        while (runtime_dispatch_next_locked(state, 0) > 0) {
+            ++progress;
         }
-        pthread_cond_broadcast(&state->rescuer_available_cond);
-        previous_status = record->emergency.status;
-        record->emergency.status = COMPLETED;
-        LOG_EMERGENCY_STATUS("RT-COMPLETED",
-                             "Emergency '%s' %s -> %s",
-                             record->emergency.name,
-                             previous_status == IN_PROGRESS
-                                 ? "IN_PROGRESS"
-                                 : previous_status == ASSIGNED ? "ASSIGNED" :
-                                       previous_status == PAUSED ? "PAUSED" : "UNKNOWN",
-                             "COMPLETED");
-
-        pthread_cond_broadcast(&state->rescuer_available_cond);
-        pthread_cond_broadcast(&state->progress_cond);
-        active_list_remove_index_locked(state, active_index);
-        pthread_mutex_unlock(&state->mutex);
+        steps += progress;
+    } while (progress > 0);
+    pthread_mutex_unlock(&state->mutex);
 
-        emergency_record_destroy(record);
-        continue;
+    return steps;
+}
 
-    worker_cleanup:
-        pthread_mutex_lock(&state->mutex);
-        if (state->shutdown_requested) {
-            for (size_t i = 0; i < record->assigned_count; ++i) {
-                int idx = record->assigned_indices ? record->assigned_indices[i] : -1;
-                if (idx < 0 || (size_t)idx >= state->rescuer_count) {
-                    continue;
-                }
-                update_rescuer_status_locked(state, idx, IDLE, record->emergency.name);
-            }
-            pthread_cond_broadcast(&state->rescuer_available_cond);
-            pthread_cond_broadcast(&state->progress_cond);
-            active_list_remove_index_locked(state, active_index);
-            pthread_mutex_unlock(&state->mutex);
-            emergency_record_destroy(record);
-        } else {
-            requeue_preempted_emergency_locked(state, record);
-            pthread_cond_broadcast(&state->progress_cond);
-            pthread_mutex_unlock(&state->mutex);
-        }
+bool runtime_state_next_timer(runtime_state_t* state, time_t* out_expires) {
+    if (!state || !out_expires) {
+        return false;
     }
 
-    return NULL;
+    pthread_mutex_lock(&state->mutex);
+    bool pending = timer_wheel_next_expiry(&state->timers, out_expires);
+    pthread_mutex_unlock(&state->mutex);
+    return pending;
 }
-
@@ -1,70 +1,300 @@
 #pragma once
 
 #include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <time.h>
 
 #include "../../emergency.h"
 #include "../../emergency_types.h"
 #include "../../rescuers.h"
 #include "../../parse_env.h"
+#include "assignment.h"
+#include "clock.h"
+#include "handoff_ring.h"
+#include "rescuer_grid.h"
+#include "slab_allocator.h"
+#include "timer_wheel.h"
+#include "type_index.h"
+#include "waiting_heap.h"
+#include "waiting_index.h"
 
+// Runtime form of an emergency, kept small so a large backlog fits a fixed
+// memory budget: the type descriptor stands for the type, its priority and
+// its name (requests carry the type's own name, so the index interns it),
+// and the units it holds are fleet indices stored inline, at the end of its
+// slab object.
 typedef struct emergency_record_t {
-    emergency_t emergency;
+    const emergency_type_descriptor_t* descriptor;
+    timer_wheel_entry_t deadline_timer; // armed while waiting
+    timer_wheel_entry_t aging_timer;    // armed while waiting and eligible for aging
+    timer_wheel_entry_t phase_timer;    // armed while assigned: arrival, then completion
+    // Links in the preemption list of its priority level and emergency
+    // type while it holds units and no worker is dispatching it.
+    struct emergency_record_t* victim_prev;
+    struct emergency_record_t* victim_next;
+    size_t heap_index;                  // slot in the waiting heap, WAITING_HEAP_NOT_QUEUED otherwise
+    unsigned long long heap_sequence;   // FIFO tie-break between equal scores
+    size_t active_index;                // slot in active_emergencies while assigned
+    size_t owner_worker;                // worker that dispatched it; its phase steps queue there
+    time_t requested_at;                // timestamp of the request
+    time_t timer_started_at;            // start of the current wait, 0 while assigned
+    time_t deadline;                    // end of the current wait, 0 for none
+    time_t travel_started_at;           // start of the current trip to the scene
+    int32_t x;
+    int32_t y;
     int priority_score;
-    int min_distance;
-    int* assigned_indices;
-    size_t assigned_count;
-
+    int min_distance; // score of the nearest dispatchable unit of a needed type
+    int nearest_unit; // the unit min_distance was measured to, -1 if none
+    // Links in the waiting index while it waits: the list of its
+    // nearest_unit, and the grid cell of its position if it has a unit.
+    struct emergency_record_t* nearest_prev;
+    struct emergency_record_t* nearest_next;
+    struct emergency_record_t* cell_prev;
+    struct emergency_record_t* cell_next;
+    int nearest_list; // WAITING_INDEX_NONE when not indexed
+    int waiting_cell; // WAITING_INDEX_NONE when in no cell
     unsigned int manage_time_total;
     unsigned int manage_time_remaining;
-
-    bool preempted;
+    emergency_status_t status;
+    short dynamic_priority;
+    short victim_level;  // level it is listed under, -1 when not listed
+    bool distance_stale; // that unit left or moved away; measured again before it is served
+    // Units it holds: all it needs while assigned; after a partial
+    // preemption, the ones it kept while it waits for replacements. The
+    // slab object has room for record_units of them.
+    size_t assigned_count;
+    int assigned_indices[];
 } emergency_record_t;
 
+static inline const char* emergency_record_name(const emergency_record_t* record) {
+    return record->descriptor ? record->descriptor->type->emergency_name : "";
+}
+
+// Most worker threads min_workers and max_workers may ask for.
+#ifndef RUNTIME_MAX_WORKERS
+#define RUNTIME_MAX_WORKERS 256
+#endif
+
+// Longest batch_window_ms accepted: dispatch waits that long each round.
+#ifndef RUNTIME_MAX_BATCH_WINDOW_MS
+#define RUNTIME_MAX_BATCH_WINDOW_MS 10000
+#endif
+
+// Queue waits of dispatched records, in one-second buckets; the last one
+// holds everything longer.
+#define RUNTIME_WAIT_BUCKETS 32
+
+struct runtime_state_t;
+struct runtime_batch_t;
+
+// One per worker thread, guarded by mutex like the handlers it runs. Ready
+// lifecycle steps are phase and return timers that have fired: the monitor
+// queues each on its owner (the worker that dispatched the record, or the
+// rescuer index modulo the pool for returns), which runs its newest step
+// first; a worker with nothing else to do steals the oldest step of
+// another. New emergencies are never queued here, they stay in the waiting
+// heap that every worker takes from in priority order. A worker parks on
+// its own wake condition, so wakeups go to one chosen thread.
+// unit_wakeups counts the times it was woken from a wait for units,
+// spurious_wakeups those after which it dispatched nothing.
+typedef struct runtime_worker_t {
+    struct runtime_state_t* state;
+    pthread_t thread;
+    size_t id;
+    timer_wheel_entry_t steps;
+    pthread_cond_t wake;
+    bool idle;             // parked until there is work, listed in idle_workers
+    bool waiting_rescuers; // parked until a unit of a type it waits for frees up
+    bool units_woken;      // woken from a wait for units, not yet back to the queue
+    bool retiring;         // asked to exit by the pool controller
+    bool started;          // has a thread that has not been joined
+    size_t dispatched;
+    size_t steps_run;
+    size_t steps_stolen;
+    size_t unit_wakeups;
+    size_t spurious_wakeups;
+} runtime_worker_t;
+
 typedef struct runtime_state_t {
+    // Queue lock: the waiting queue, the active list, the records, the
+    // timers and the rescuers' positions. Each rescuer type also has a lock
+    // of its own (type_locks) over the status and return time of its
+    // units and their slots in available_grid; a position changes only
+    // with both held. Lock order: mutex first, then type locks in
+    // ascending type ID; the dispatch fast path drops mutex and takes just
+    // the types a record needs, so emergencies needing different types
+    // allocate in parallel.
     pthread_mutex_t mutex;
-    pthread_cond_t emergency_available_cond;
-    pthread_cond_t rescuer_available_cond;
+    pthread_mutex_t* type_locks; // one per rescuer type
+    size_t type_lock_count;
     pthread_cond_t progress_cond;
 
-    emergency_record_t** waiting_queue;
-    size_t waiting_count;
-    size_t waiting_capacity;
+    waiting_heap_t waiting;
+
+    // Records come from record_slab, each object sized for the most units
+    // an emergency type needs (record_units), so dispatch allocates
+    // nothing; the slab, the waiting heap and the active list are sized at
+    // start for the rescuers plus the bursts the ingest can hand over.
+    slab_allocator_t record_slab;
+    size_t record_units;
 
     emergency_record_t** active_emergencies;
     size_t active_count;
     size_t active_capacity;
+    // Preemption index over the active records: one list per (priority
+    // level, emergency type ID), most recently assigned first, and per
+    // (priority level, rescuer type ID) the units those records hold.
+    emergency_record_t** victim_lists; // [level * emergency type count + ID]
+    size_t* victim_units;              // [level * rescuer type count + ID]
+    // Preemption planner scratch, sized at start; guarded by mutex and
+    // every type lock like the planner itself.
+    long long* preempt_need;    // per rescuer type
+    long long* preempt_missing; // per rescuer type
+    long long* preempt_held;    // per rescuer type
+    emergency_record_t** preempt_cursor;  // per emergency type
+    emergency_record_t** preempt_victims; // per rescuer, the most records that can hold units
 
+    // The fleet, taken over from the caller at init: the only copy of the
+    // units; the grid and the rescore lists index it by position.
     rescuer_digital_twin_t* rescuer_pool;
     size_t rescuer_count;
 
-    pthread_t* workers;
+    // Dispatchable (IDLE or RETURNING_TO_BASE) rescuers by type and
+    // position, kept in step with every status and position change.
+    rescuer_grid_t available_grid;
+    int* rescuer_type_ids; // per rescuer, -1 if its type is not indexed
+    // Units whose status or position changed since the waiting records
+    // were last scored: per type, rescore_units[rescore_start[t] ..
+    // + rescore_count[t]), deduplicated by rescore_flag and guarded by the
+    // type lock. rescore_pending counts them all, so the queue side can
+    // tell without taking any type lock.
+    int* rescore_units;
+    size_t* rescore_start;
+    size_t* rescore_count;
+    size_t* rescore_kept; // per type: the dispatchable prefix, during a rescore pass
+    unsigned char* rescore_flag; // per rescuer
+    atomic_size_t rescore_pending;
+    // The waiting records by nearest unit and position, guarded by mutex:
+    // a rescore pass visits only the records a filed unit can change.
+    waiting_index_t waiting_index;
+
+    const emergency_type_index_t* type_index;
+    const runtime_clock_t* clock; // NULL = wall clock
+
+    // Worker slots [0, worker_count) are running, out of worker_capacity
+    // (max_workers) allocated at start. Once a second the pool controller
+    // (scale_timer, on the monitor) looks at the backlog and at the 90th
+    // percentile of the queue wait of the records dispatched in that
+    // second (wait_histogram, one bucket per second), and adds a worker
+    // after RUNTIME_SCALE_UP_TICKS seconds of pressure with none idle, or
+    // retires the top slot after RUNTIME_SCALE_DOWN_TICKS idle seconds.
+    runtime_worker_t* workers;
     size_t worker_count;
+    size_t worker_capacity;
+    size_t* idle_workers; // parked idle workers, most recently parked last
+    size_t idle_count;
+    // Rescuer wait channels. A worker whose dispatch found too few free
+    // units parks listed under each type the head of the queue is short
+    // of (rescuer_waiters[type * worker_capacity + worker]); units let go
+    // wake one worker listed under their type, and only once the head can
+    // be served. rescuer_wait_head and its heap sequence name the head
+    // they are keyed on; when another record takes its place they are
+    // listed again for the new head without being woken.
+    unsigned char* rescuer_waiters;
+    size_t rescuer_wait_count;
+    const emergency_record_t* rescuer_wait_head;
+    unsigned long long rescuer_wait_sequence;
+    size_t min_workers;
+    size_t max_workers;
+    timer_wheel_entry_t scale_timer;
+    unsigned int scale_up_ticks;
+    unsigned int scale_down_ticks;
+    bool retire_pending;
+    unsigned int wait_histogram[RUNTIME_WAIT_BUCKETS];
+    size_t wait_samples;
 
     pthread_t monitor_thread;
     int monitor_running;
 
+    // Waiting deadlines, aging steps and rescuer returns. The monitor sleeps
+    // on timer_cond until the earliest expiry (monitor_wake_at, 0 = none)
+    // and only touches the entries that fired.
+    timer_wheel_t timers;
+    timer_wheel_entry_t* return_timers; // one per rescuer
+    pthread_cond_t timer_cond;
+    time_t monitor_wake_at;
+
+    // Consumers push prepared records here without taking mutex; the ingest
+    // thread (woken through the doorbell) and the workers splice them into
+    // the waiting queue while holding it.
+    handoff_ring_t ingest_ring;
+    sem_t ingest_doorbell;
+    pthread_t ingest_thread;
+    int ingest_running;
+    atomic_bool ingest_closed;
+
     unsigned int priority_timeouts[3];
     unsigned int aging_start_seconds;
     unsigned int aging_step_seconds;
 
+    // Batched dispatch, on when batch_window_ms > 0: one worker at a time
+    // lets arrivals gather for the window (batch_collecting, the other
+    // workers stay parked meanwhile), then assigns
+    // the longest prefix of the queue that fits the free units with a
+    // min-cost solver, one priority level after the other.
+    unsigned int batch_window_ms;
+    bool batch_collecting;
+    assignment_solver_t batch_solver;
+    struct runtime_batch_t* batch; // buffers of the round, kept between rounds
+
+    // Arrivals on scene and the total seconds from request to arrival,
+    // for the response-time figure of the simulation report.
+    size_t arrivals;
+    long long arrival_wait_seconds;
+
     int shutdown_requested;
 } runtime_state_t;
 
+// On success the runtime owns rescuers (an array from
+// parse_rescuer_type()) and frees it on destroy; on failure the caller
+// still does.
 int runtime_state_init(runtime_state_t* state,
-                       const rescuer_digital_twin_t* rescuers,
+                       rescuer_digital_twin_t* rescuers,
                        size_t rescuer_count,
-                       const environment_variable_t* environment);
+                       const environment_variable_t* environment,
+                       const emergency_type_index_t* type_index,
+                       const runtime_clock_t* clock);
 
 void runtime_state_destroy(runtime_state_t* state);
 
+// A worker_count above zero runs a fixed pool of that size; zero lets the
+// pool controller size it between min_workers and max_workers.
 int runtime_state_start_workers(runtime_state_t* state, size_t worker_count);
 void runtime_state_request_shutdown(runtime_state_t* state);
 void runtime_state_join_workers(runtime_state_t* state);
 
-int runtime_state_dispatch_request(runtime_state_t* state,
-                                   const emergency_request_t* request,
-                                   const emergency_type_t* emergency_types,
-                                   size_t emergency_type_count);
+// Hands the records the calling thread keeps cached back to the runtime;
+// for threads that dispatched or finished emergencies and exit while the
+// runtime lives on.
+void runtime_state_release_thread_cache(runtime_state_t* state);
+
+// Current time on the runtime's clock.
+time_t runtime_state_now(const runtime_state_t* state);
+
+int runtime_state_dispatch_request(runtime_state_t* state, const emergency_request_t* request);
+
+int runtime_state_dispatch_batch(runtime_state_t* state,
+                                 const emergency_request_t* requests,
+                                 size_t request_count);
+
+// Single-threaded stepping for the virtual clock; no worker, monitor or
+// ingest thread may be running. settle admits handed-off records, fires the
+// timers due at the current time and dispatches until nothing changes,
+// returning the number of steps taken. next_timer reports the earliest
+// pending expiry.
+size_t runtime_state_settle(runtime_state_t* state);
+bool runtime_state_next_timer(runtime_state_t* state, time_t* out_expires);
@@ -0,0 +1,213 @@
+#include "timer_wheel.h"
+
+#include <stdint.h>
+
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_SPAN ((time_t)1 << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS))
+
+static inline void list_init(timer_wheel_entry_t* head) {
+    head->next = head;
+    head->prev = head;
+}
+
+static inline bool list_empty(const timer_wheel_entry_t* head) {
+    return head->next == head;
+}
+
+static inline void list_append(timer_wheel_entry_t* head, timer_wheel_entry_t* entry) {
+    entry->prev = head->prev;
+    entry->next = head;
+    head->prev->next = entry;
+    head->prev = entry;
+}
+
+static inline void list_unlink(timer_wheel_entry_t* entry) {
+    entry->prev->next = entry->next;
+    entry->next->prev = entry->prev;
+    entry->next = NULL;
+    entry->prev = NULL;
+}
+
+// Moves every entry of src to the end of dst.
+static void list_splice(timer_wheel_entry_t* dst, timer_wheel_entry_t* src) {
+    if (list_empty(src)) {
+        return;
+    }
+
+    timer_wheel_entry_t* first = src->next;
+    timer_wheel_entry_t* last = src->prev;
+    first->prev = dst->prev;
+    last->next = dst;
+    dst->prev->next = first;
+    dst->prev = last;
+    list_init(src);
+}
+
+static inline size_t slot_index(time_t when, int level) {
+    return (size_t)(((uint64_t)when >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_MASK);
+}
+
+static void place(timer_wheel_t* wheel, timer_wheel_entry_t* entry) {
+    if (entry->expires <= wheel->now) {
+        list_append(&wheel->due, entry);
+        return;
+    }
+
+    time_t when = entry->expires;
+    if (when - wheel->now >= TIMER_WHEEL_SPAN) {
+        when = wheel->now + TIMER_WHEEL_SPAN - 1;
+    }
+
+    time_t delta = when - wheel->now;
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= ((time_t)1 << ((level + 1) * TIMER_WHEEL_SLOT_BITS))) {
+        ++level;
+    }
+
+    list_append(&wheel->slots[level][slot_index(when, level)], entry);
+}
+
+static void replace_list(timer_wheel_t* wheel, timer_wheel_entry_t* list) {
+    while (!list_empty(list)) {
+        timer_wheel_entry_t* entry = list->next;
+        list_unlink(entry);
+        place(wheel, entry);
+    }
+}
+
+void timer_wheel_init(timer_wheel_t* wheel, time_t now) {
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; ++level) {
+        for (size_t slot = 0; slot < TIMER_WHEEL_SLOTS; ++slot) {
+            list_init(&wheel->slots[level][slot]);
+        }
+    }
+    list_init(&wheel->due);
+    wheel->now = now;
+}
+
+void timer_wheel_schedule(timer_wheel_t* wheel, timer_wheel_entry_t* entry, time_t expires) {
+    if (timer_wheel_entry_armed(entry)) {
+        list_unlink(entry);
+    }
+
+    entry->expires = expires;
+    place(wheel, entry);
+}
+
+void timer_wheel_cancel(timer_wheel_entry_t* entry) {
+    if (entry && timer_wheel_entry_armed(entry)) {
+        list_unlink(entry);
+    }
+}
+
+void timer_wheel_advance(timer_wheel_t* wheel, time_t now) {
+    if (now <= wheel->now) {
+        return;
+    }
+
+    // After a long sleep (or a clock jump) re-placing everything is cheaper
+    // than stepping through every second.
+    if (now - wheel->now >= TIMER_WHEEL_SPAN) {
+        timer_wheel_entry_t pending;
+        list_init(&pending);
+        for (int level = 0; level < TIMER_WHEEL_LEVELS; ++level) {
+            for (size_t slot = 0; slot < TIMER_WHEEL_SLOTS; ++slot) {
+                list_splice(&pending, &wheel->slots[level][slot]);
+            }
+        }
+        wheel->now = now;
+        replace_list(wheel, &pending);
+        return;
+    }
+
+    while (wheel->now < now) {
+        time_t tick = ++wheel->now;
+
+        // Cascade from the highest level whose slot boundary was crossed
+        // down to level 1, then fire level 0.
+        int top = 0;
+        while (top < TIMER_WHEEL_LEVELS - 1 &&
+               ((uint64_t)tick & (((uint64_t)1 << ((top + 1) * TIMER_WHEEL_SLOT_BITS)) - 1)) == 0) {
+            ++top;
+        }
+        for (int level = top; level >= 1; --level) {
+            timer_wheel_entry_t pending;
+            list_init(&pending);
+            list_splice(&pending, &wheel->slots[level][slot_index(tick, level)]);
+            replace_list(wheel, &pending);
+        }
+
+        list_splice(&wheel->due, &wheel->slots[0][slot_index(tick, 0)]);
+    }
+}
+
+timer_wheel_entry_t* timer_wheel_pop_due(timer_wheel_t* wheel) {
+    return timer_wheel_list_pop_front(&wheel->due);
+}
+
+bool timer_wheel_next_expiry(const timer_wheel_t* wheel, time_t* out_expires) {
+    if (!list_empty(&wheel->due)) {
+        *out_expires = wheel->now;
+        return true;
+    }
+
+    // Within one level the slots after the current position hold increasing
+    // expiries, so only the first non-empty slot of each level can hold the
+    // minimum; levels can overlap, hence the minimum across them. The last
+    // level also parks expiries beyond the wheel's span in earlier slots, so
+    // all of its slots are checked.
+    bool found = false;
+    time_t best = 0;
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; ++level) {
+        bool last_level = level == TIMER_WHEEL_LEVELS - 1;
+        size_t current = slot_index(wheel->now, level);
+        for (size_t offset = 1; offset <= TIMER_WHEEL_SLOTS; ++offset) {
+            const timer_wheel_entry_t* head = &wheel->slots[level][(current + offset) & TIMER_WHEEL_MASK];
+            if (list_empty(head)) {
+                continue;
+            }
+            for (const timer_wheel_entry_t* entry = head->next; entry != head; entry = entry->next) {
+                if (!found || entry->expires < best) {
+                    best = entry->expires;
+                    found = true;
+                }
+            }
+            if (!last_level) {
+                break;
+            }
+        }
+    }
+
+    if (found) {
+        *out_expires = best;
+    }
+    return found;
+}
+
+void timer_wheel_list_init(timer_wheel_entry_t* head) {
+    list_init(head);
+}
+
+void timer_wheel_list_push(timer_wheel_entry_t* head, timer_wheel_entry_t* entry) {
+    list_append(head, entry);
+}
+
+timer_wheel_entry_t* timer_wheel_list_pop_front(timer_wheel_entry_t* head) {
+    if (list_empty(head)) {
+        return NULL;
+    }
+
+    timer_wheel_entry_t* entry = head->next;
+    list_unlink(entry);
+    return entry;
+}
+
+timer_wheel_entry_t* timer_wheel_list_pop_back(timer_wheel_entry_t* head) {
+    if (list_empty(head)) {
+        return NULL;
+    }
+
+    timer_wheel_entry_t* entry = head->prev;
+    list_unlink(entry);
+    return entry;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+
+// Intrusive timer. Embed it in the owning object and recover the owner from
+// kind; an entry whose next is NULL is not armed.
+typedef struct timer_wheel_entry_t {
+    struct timer_wheel_entry_t* next;
+    struct timer_wheel_entry_t* prev;
+    time_t expires;
+    int kind;
+} timer_wheel_entry_t;
+
+// Hierarchical timing wheel with one-second resolution: four levels of 64
+// slots cover about 194 days, later expiries are parked in the last level
+// and re-placed when it cascades. Scheduling and cancelling are O(1);
+// advancing costs one step per elapsed second plus the entries that fire or
+// cascade.
+typedef struct timer_wheel_t {
+    timer_wheel_entry_t slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    timer_wheel_entry_t due;
+    time_t now;
+} timer_wheel_t;
+
+void timer_wheel_init(timer_wheel_t* wheel, time_t now);
+
+static inline void timer_wheel_entry_init(timer_wheel_entry_t* entry, int kind) {
+    entry->next = NULL;
+    entry->prev = NULL;
+    entry->expires = 0;
+    entry->kind = kind;
+}
+
+static inline bool timer_wheel_entry_armed(const timer_wheel_entry_t* entry) {
+    return entry->next != NULL;
+}
+
+// Arms (or re-arms) the entry. Expiries at or before the wheel's current
+// time are due immediately.
+void timer_wheel_schedule(timer_wheel_t* wheel, timer_wheel_entry_t* entry, time_t expires);
+
+// Safe on entries that are not armed, including ones already handed out as due.
+void timer_wheel_cancel(timer_wheel_entry_t* entry);
+
+// Moves every entry expiring at or before now to the due list.
+void timer_wheel_advance(timer_wheel_t* wheel, time_t now);
+
+// Returns the next due entry (disarmed) or NULL. Entries are popped one at a
+// time so handlers may cancel other due entries.
+timer_wheel_entry_t* timer_wheel_pop_due(timer_wheel_t* wheel);
+
+// Earliest pending expiry; false when nothing is armed.
+bool timer_wheel_next_expiry(const timer_wheel_t* wheel, time_t* out_expires);
+
+// Lists of due entries kept by the caller until they are handled. A parked
+// entry still counts as armed, so timer_wheel_cancel and
+// timer_wheel_schedule take it off the list it is on.
+void timer_wheel_list_init(timer_wheel_entry_t* head);
+void timer_wheel_list_push(timer_wheel_entry_t* head, timer_wheel_entry_t* entry);
+timer_wheel_entry_t* timer_wheel_list_pop_front(timer_wheel_entry_t* head);
+timer_wheel_entry_t* timer_wheel_list_pop_back(timer_wheel_entry_t* head);
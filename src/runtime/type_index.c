@@ -0,0 +1,156 @@
+#include "type_index.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../logging.h"
+
+static uint32_t hash_name(const char* name) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)name; *p; ++p) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int build_slots(emergency_type_index_t* index) {
+    size_t slot_count = 4;
+    while (slot_count < index->count * 2) {
+        slot_count *= 2;
+    }
+
+    index->slots = malloc(slot_count * sizeof(int32_t));
+    if (!index->slots) {
+        return -1;
+    }
+    for (size_t i = 0; i < slot_count; ++i) {
+        index->slots[i] = -1;
+    }
+    index->slot_mask = slot_count - 1;
+
+    for (size_t id = 0; id < index->count; ++id) {
+        const char* name = index->descriptors[id].type->emergency_name;
+        if (!name) {
+            continue;
+        }
+        if (emergency_type_index_lookup(index, name) >= 0) {
+            LOG_CONFIGURATION("CFG-EMERGENCY-DUP", "Duplicate emergency type '%s' ignored for lookups", name);
+            continue;
+        }
+        size_t slot = hash_name(name) & index->slot_mask;
+        while (index->slots[slot] >= 0) {
+            slot = (slot + 1) & index->slot_mask;
+        }
+        index->slots[slot] = (int32_t)id;
+    }
+
+    return 0;
+}
+
+int emergency_type_index_build(emergency_type_index_t* index,
+                               const emergency_type_t* emergency_types,
+                               size_t emergency_type_count,
+                               const rescuer_type_t* rescuer_types,
+                               size_t rescuer_type_count) {
+    if (!index || (!emergency_types && emergency_type_count > 0)) {
+        return -1;
+    }
+
+    memset(index, 0, sizeof(*index));
+    index->rescuer_types = rescuer_types;
+    index->rescuer_type_count = rescuer_type_count;
+    index->count = emergency_type_count;
+
+    index->descriptors = calloc(emergency_type_count + 1, sizeof(emergency_type_descriptor_t));
+    index->demand_storage = calloc(emergency_type_count * rescuer_type_count + 1, sizeof(int));
+    if (!index->descriptors || !index->demand_storage) {
+        emergency_type_index_destroy(index);
+        return -1;
+    }
+
+    for (size_t id = 0; id < emergency_type_count; ++id) {
+        const emergency_type_t* type = &emergency_types[id];
+        emergency_type_descriptor_t* descriptor = &index->descriptors[id];
+        int* demand = &index->demand_storage[id * rescuer_type_count];
+
+        descriptor->type = type;
+        descriptor->id = (int)id;
+        descriptor->demand = demand;
+        descriptor->max_manage_time = 1;
+
+        for (int r = 0; r < type->rescuers_req_number; ++r) {
+            const rescuer_request_t* request = &type->rescuer_requests[r];
+            if (request->required_count > 0) {
+                descriptor->total_units += request->required_count;
+                int rescuer_id = emergency_type_index_rescuer_id(index, request->type);
+                if (rescuer_id >= 0) {
+                    demand[rescuer_id] += request->required_count;
+                }
+            }
+            if (request->time_to_manage > (int)descriptor->max_manage_time) {
+                descriptor->max_manage_time = (unsigned int)request->time_to_manage;
+            }
+        }
+    }
+
+    if (build_slots(index) != 0) {
+        emergency_type_index_destroy(index);
+        return -1;
+    }
+
+    LOG_CONFIGURATION("CFG-TYPE-INDEX",
+                      "Indexed %zu emergency types over %zu rescuer types",
+                      emergency_type_count,
+                      rescuer_type_count);
+    return 0;
+}
+
+void emergency_type_index_destroy(emergency_type_index_t* index) {
+    if (!index) {
+        return;
+    }
+
+    free(index->slots);
+    free(index->demand_storage);
+    free(index->descriptors);
+    memset(index, 0, sizeof(*index));
+}
+
+int emergency_type_index_lookup(const emergency_type_index_t* index, const char* name) {
+    if (!index || !index->slots || !name) {
+        return -1;
+    }
+
+    size_t slot = hash_name(name) & index->slot_mask;
+    while (index->slots[slot] >= 0) {
+        int32_t id = index->slots[slot];
+        if (strcmp(index->descriptors[id].type->emergency_name, name) == 0) {
+            return (int)id;
+        }
+        slot = (slot + 1) & index->slot_mask;
+    }
+
+    return -1;
+}
+
+const emergency_type_descriptor_t* emergency_type_index_get(const emergency_type_index_t* index, int id) {
+    if (!index || id < 0 || (size_t)id >= index->count) {
+        return NULL;
+    }
+
+    return &index->descriptors[id];
+}
+
+int emergency_type_index_rescuer_id(const emergency_type_index_t* index, const rescuer_type_t* type) {
+    if (!index || !type || !index->rescuer_types) {
+        return -1;
+    }
+
+    if (type < index->rescuer_types || type >= index->rescuer_types + index->rescuer_type_count) {
+        return -1;
+    }
+
+    return (int)(type - index->rescuer_types);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../../emergency_types.h"
+#include "../../rescuers.h"
+
+// Everything the dispatcher needs about an emergency type, computed once
+// when the configuration is loaded.
+typedef struct emergency_type_descriptor_t {
+    const emergency_type_t* type;
+    int id;
+    int total_units;
+    unsigned int max_manage_time;
+    const int* demand; // required units per rescuer type ID
+} emergency_type_descriptor_t;
+
+typedef struct emergency_type_index_t {
+    emergency_type_descriptor_t* descriptors;
+    size_t count;
+
+    const rescuer_type_t* rescuer_types;
+    size_t rescuer_type_count;
+    int* demand_storage;
+
+    // Open-addressing table of descriptor IDs keyed by name, kept at most
+    // half full so lookups stay O(1).
+    int32_t* slots;
+    size_t slot_mask;
+} emergency_type_index_t;
+
+int emergency_type_index_build(emergency_type_index_t* index,
+                               const emergency_type_t* emergency_types,
+                               size_t emergency_type_count,
+                               const rescuer_type_t* rescuer_types,
+                               size_t rescuer_type_count);
+void emergency_type_index_destroy(emergency_type_index_t* index);
+
+// Returns the type ID for name, or -1 if it is unknown.
+int emergency_type_index_lookup(const emergency_type_index_t* index, const char* name);
+
+const emergency_type_descriptor_t* emergency_type_index_get(const emergency_type_index_t* index, int id);
+
+// Returns the ID of a rescuer type owned by the index, or -1.
+int emergency_type_index_rescuer_id(const emergency_type_index_t* index, const rescuer_type_t* type);
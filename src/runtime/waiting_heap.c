@@ -0,0 +1,173 @@
+#include "waiting_heap.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "state.h"
+
+static inline bool waiting_heap_before(const emergency_record_t* a, const emergency_record_t* b) {
+    if (a->priority_score != b->priority_score) {
+        return a->priority_score > b->priority_score;
+    }
+    return a->heap_sequence < b->heap_sequence;
+}
+
+static inline void waiting_heap_place(waiting_heap_t* heap, size_t index, emergency_record_t* record) {
+    heap->items[index] = record;
+    record->heap_index = index;
+}
+
+static void waiting_heap_sift_up(waiting_heap_t* heap, size_t index) {
+    emergency_record_t* record = heap->items[index];
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!waiting_heap_before(record, heap->items[parent])) {
+            break;
+        }
+        waiting_heap_place(heap, index, heap->items[parent]);
+        index = parent;
+    }
+    waiting_heap_place(heap, index, record);
+}
+
+static void waiting_heap_sift_down(waiting_heap_t* heap, size_t index) {
+    emergency_record_t* record = heap->items[index];
+    for (;;) {
+        size_t child = 2 * index + 1;
+        if (child >= heap->count) {
+            break;
+        }
+        if (child + 1 < heap->count && waiting_heap_before(heap->items[child + 1], heap->items[child])) {
+            ++child;
+        }
+        if (!waiting_heap_before(heap->items[child], record)) {
+            break;
+        }
+        waiting_heap_place(heap, index, heap->items[child]);
+        index = child;
+    }
+    waiting_heap_place(heap, index, record);
+}
+
+void waiting_heap_init(waiting_heap_t* heap) {
+    if (!heap) {
+        return;
+    }
+
+    memset(heap, 0, sizeof(*heap));
+}
+
+void waiting_heap_destroy(waiting_heap_t* heap) {
+    if (!heap) {
+        return;
+    }
+
+    for (size_t i = 0; i < heap->count; ++i) {
+        heap->items[i]->heap_index = WAITING_HEAP_NOT_QUEUED;
+    }
+    free(heap->items);
+    memset(heap, 0, sizeof(*heap));
+}
+
+int waiting_heap_reserve(waiting_heap_t* heap, size_t capacity) {
+    if (!heap) {
+        return -1;
+    }
+    if (capacity <= heap->capacity) {
+        return 0;
+    }
+
+    emergency_record_t** tmp = realloc(heap->items, capacity * sizeof(emergency_record_t*));
+    if (!tmp) {
+        return -1;
+    }
+    heap->items = tmp;
+    heap->capacity = capacity;
+    return 0;
+}
+
+int waiting_heap_push(waiting_heap_t* heap, emergency_record_t* record) {
+    if (!heap || !record) {
+        return -1;
+    }
+
+    if (heap->count == heap->capacity) {
+        size_t new_capacity = heap->capacity == 0 ? 16 : heap->capacity * 2;
+        emergency_record_t** tmp = realloc(heap->items, new_capacity * sizeof(emergency_record_t*));
+        if (!tmp) {
+            return -1;
+        }
+        heap->items = tmp;
+        heap->capacity = new_capacity;
+    }
+
+    record->heap_sequence = heap->next_sequence++;
+    heap->items[heap->count] = record;
+    record->heap_index = heap->count;
+    heap->count++;
+    waiting_heap_sift_up(heap, heap->count - 1);
+    return 0;
+}
+
+emergency_record_t* waiting_heap_peek(const waiting_heap_t* heap) {
+    if (!heap || heap->count == 0) {
+        return NULL;
+    }
+
+    return heap->items[0];
+}
+
+emergency_record_t* waiting_heap_pop(waiting_heap_t* heap) {
+    emergency_record_t* top = waiting_heap_peek(heap);
+    if (top) {
+        waiting_heap_remove(heap, top);
+    }
+    return top;
+}
+
+int waiting_heap_remove(waiting_heap_t* heap, emergency_record_t* record) {
+    if (!heap || !record || record->heap_index >= heap->count || heap->items[record->heap_index] != record) {
+        return -1;
+    }
+
+    size_t index = record->heap_index;
+    record->heap_index = WAITING_HEAP_NOT_QUEUED;
+    heap->count--;
+
+    if (index == heap->count) {
+        return 0;
+    }
+
+    // Move the last record into the hole; it may belong above or below it.
+    waiting_heap_place(heap, index, heap->items[heap->count]);
+    if (index > 0 && waiting_heap_before(heap->items[index], heap->items[(index - 1) / 2])) {
+        waiting_heap_sift_up(heap, index);
+    } else {
+        waiting_heap_sift_down(heap, index);
+    }
+    return 0;
+}
+
+void waiting_heap_update(waiting_heap_t* heap, emergency_record_t* record) {
+    if (!heap || !record || record->heap_index >= heap->count || heap->items[record->heap_index] != record) {
+        return;
+    }
+
+    size_t index = record->heap_index;
+    if (index > 0 && waiting_heap_before(record, heap->items[(index - 1) / 2])) {
+        waiting_heap_sift_up(heap, index);
+    } else {
+        waiting_heap_sift_down(heap, index);
+    }
+}
+
+void waiting_heap_rebuild(waiting_heap_t* heap) {
+    if (!heap || heap->count < 2) {
+        return;
+    }
+
+    for (size_t index = heap->count / 2; index-- > 0;) {
+        waiting_heap_sift_down(heap, index);
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stddef.h>
+
+struct emergency_record_t;
+
+// Marks a record that is not in any waiting heap.
+#define WAITING_HEAP_NOT_QUEUED ((size_t)-1)
+
+// Indexed binary max-heap of waiting emergencies ordered by priority_score,
+// ties broken by insertion order. Each record stores its own slot in
+// heap_index, so removal and re-keying of an arbitrary record are
+// O(log n) without searching.
+typedef struct waiting_heap_t {
+    struct emergency_record_t** items;
+    size_t count;
+    size_t capacity;
+    unsigned long long next_sequence;
+} waiting_heap_t;
+
+void waiting_heap_init(waiting_heap_t* heap);
+
+// Frees the heap storage only; the records are owned by the caller.
+void waiting_heap_destroy(waiting_heap_t* heap);
+
+// Grows the storage to hold capacity records, so pushes up to there never
+// reallocate. Returns -1 on allocation failure.
+int waiting_heap_reserve(waiting_heap_t* heap, size_t capacity);
+
+int waiting_heap_push(waiting_heap_t* heap, struct emergency_record_t* record);
+struct emergency_record_t* waiting_heap_peek(const waiting_heap_t* heap);
+struct emergency_record_t* waiting_heap_pop(waiting_heap_t* heap);
+
+// Returns -1 if the record is not in this heap.
+int waiting_heap_remove(waiting_heap_t* heap, struct emergency_record_t* record);
+
+// Restores the heap order after the record's priority_score changed.
+void waiting_heap_update(waiting_heap_t* heap, struct emergency_record_t* record);
+
+// Restores the heap order after any number of priority_score changes, in
+// O(n); cheaper than one update per record once many have changed.
+void waiting_heap_rebuild(waiting_heap_t* heap);
+
+static inline size_t waiting_heap_count(const waiting_heap_t* heap) {
+    return heap ? heap->count : 0;
+}
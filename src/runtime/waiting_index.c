@@ -0,0 +1,243 @@
+#include "waiting_index.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "state.h"
+
+static int clamp_cell(long long value, int cell_size, int count) {
+    if (value < 0) {
+        return 0;
+    }
+    long long cell = value / cell_size;
+    return cell < count ? (int)cell : count - 1;
+}
+
+// Distance along one axis from v to a cell. Border cells extend to
+// infinity, so records outside the map still get a valid lower bound.
+static long long axis_gap(int v, int cell, int count, int cell_size) {
+    if (cell > 0) {
+        long long lo = (long long)cell * cell_size;
+        if (v < lo) {
+            return lo - v;
+        }
+    }
+    if (cell < count - 1) {
+        long long hi = (long long)(cell + 1) * cell_size - 1;
+        if (v > hi) {
+            return v - hi;
+        }
+    }
+    return 0;
+}
+
+int waiting_index_init(waiting_index_t* index, int width, int height, size_t type_count, size_t unit_count) {
+    if (!index) {
+        return -1;
+    }
+
+    memset(index, 0, sizeof(*index));
+
+    int cell_size = 1;
+    if (width > 0 && height > 0) {
+        int side = width > height ? width : height;
+        cell_size = side / WAITING_INDEX_SIDE + (side % WAITING_INDEX_SIDE != 0);
+    }
+    index->cell_size = cell_size;
+    index->columns = width > 0 && height > 0 ? (width + cell_size - 1) / cell_size : 1;
+    index->rows = width > 0 && height > 0 ? (height + cell_size - 1) / cell_size : 1;
+    index->type_count = type_count;
+    index->unit_count = unit_count;
+
+    size_t cell_count = (size_t)index->rows * (size_t)index->columns;
+    index->cells = calloc(cell_count, sizeof(struct emergency_record_t*));
+    index->bounds = calloc(cell_count * (type_count ? type_count : 1), sizeof(int));
+    index->type_bounds = calloc(type_count ? type_count : 1, sizeof(int));
+    index->lists = calloc(unit_count + 1, sizeof(struct emergency_record_t*));
+    if (!index->cells || !index->bounds || !index->type_bounds || !index->lists) {
+        waiting_index_destroy(index);
+        return -1;
+    }
+    return 0;
+}
+
+void waiting_index_destroy(waiting_index_t* index) {
+    if (!index) {
+        return;
+    }
+    free(index->cells);
+    free(index->bounds);
+    free(index->type_bounds);
+    free(index->lists);
+    memset(index, 0, sizeof(*index));
+}
+
+static void list_unlink(waiting_index_t* index, emergency_record_t* record) {
+    if (record->nearest_list == WAITING_INDEX_NONE) {
+        return;
+    }
+    if (record->nearest_prev) {
+        record->nearest_prev->nearest_next = record->nearest_next;
+    } else {
+        index->lists[record->nearest_list] = record->nearest_next;
+    }
+    if (record->nearest_next) {
+        record->nearest_next->nearest_prev = record->nearest_prev;
+    }
+    record->nearest_prev = NULL;
+    record->nearest_next = NULL;
+    record->nearest_list = WAITING_INDEX_NONE;
+}
+
+static void cell_unlink(waiting_index_t* index, emergency_record_t* record) {
+    if (record->waiting_cell == WAITING_INDEX_NONE) {
+        return;
+    }
+    if (record->cell_prev) {
+        record->cell_prev->cell_next = record->cell_next;
+    } else {
+        index->cells[record->waiting_cell] = record->cell_next;
+    }
+    if (record->cell_next) {
+        record->cell_next->cell_prev = record->cell_prev;
+    }
+    record->cell_prev = NULL;
+    record->cell_next = NULL;
+    record->waiting_cell = WAITING_INDEX_NONE;
+}
+
+void waiting_index_file(waiting_index_t* index, emergency_record_t* record) {
+    if (!index || !record) {
+        return;
+    }
+
+    int list = record->nearest_unit >= 0 && (size_t)record->nearest_unit < index->unit_count
+                   ? record->nearest_unit
+                   : (int)index->unit_count;
+    if (record->nearest_list != list) {
+        list_unlink(index, record);
+        record->nearest_next = index->lists[list];
+        if (record->nearest_next) {
+            record->nearest_next->nearest_prev = record;
+        }
+        index->lists[list] = record;
+        record->nearest_list = list;
+    }
+
+    // A record no unit can reach is beaten by any unit: it stays out of the
+    // cells so their bounds keep meaning something.
+    if (list == (int)index->unit_count) {
+        cell_unlink(index, record);
+        return;
+    }
+
+    if (record->waiting_cell == WAITING_INDEX_NONE) {
+        int cell = clamp_cell(record->y, index->cell_size, index->rows) * index->columns +
+                   clamp_cell(record->x, index->cell_size, index->columns);
+        record->cell_next = index->cells[cell];
+        if (record->cell_next) {
+            record->cell_next->cell_prev = record;
+        }
+        index->cells[cell] = record;
+        record->waiting_cell = cell;
+    }
+
+    size_t cell_count = (size_t)index->rows * (size_t)index->columns;
+    const int* demand = record->descriptor->demand;
+    for (size_t t = 0; t < index->type_count; ++t) {
+        if (demand[t] <= 0) {
+            continue;
+        }
+        int* bound = &index->bounds[t * cell_count + (size_t)record->waiting_cell];
+        if (record->min_distance > *bound) {
+            *bound = record->min_distance;
+        }
+        if (record->min_distance > index->type_bounds[t]) {
+            index->type_bounds[t] = record->min_distance;
+        }
+    }
+}
+
+void waiting_index_remove(waiting_index_t* index, emergency_record_t* record) {
+    if (!index || !record) {
+        return;
+    }
+    // Bounds are left as they are: still upper bounds, tightened the next
+    // time the cell is visited.
+    list_unlink(index, record);
+    cell_unlink(index, record);
+}
+
+emergency_record_t* waiting_index_first(const waiting_index_t* index, int unit) {
+    if (!index) {
+        return NULL;
+    }
+    if (unit < 0 || (size_t)unit >= index->unit_count) {
+        return index->lists[index->unit_count];
+    }
+    return index->lists[unit];
+}
+
+void waiting_index_reach(waiting_index_t* index,
+                         int type_id,
+                         int x,
+                         int y,
+                         long long delay,
+                         waiting_index_visit_t visit,
+                         void* arg) {
+    if (!index || !visit || type_id < 0 || (size_t)type_id >= index->type_count) {
+        return;
+    }
+
+    // A record farther than reach already has a unit at least as good.
+    long long reach = (long long)index->type_bounds[type_id] - delay;
+    if (reach <= 0) {
+        return;
+    }
+
+    size_t cell_count = (size_t)index->rows * (size_t)index->columns;
+    int* bounds = &index->bounds[(size_t)type_id * cell_count];
+    int first_column = clamp_cell((long long)x - reach, index->cell_size, index->columns);
+    int last_column = clamp_cell((long long)x + reach, index->cell_size, index->columns);
+    int first_row = clamp_cell((long long)y - reach, index->cell_size, index->rows);
+    int last_row = clamp_cell((long long)y + reach, index->cell_size, index->rows);
+    int largest = 0;
+
+    for (int row = first_row; row <= last_row; ++row) {
+        long long row_gap = axis_gap(y, row, index->rows, index->cell_size);
+        for (int column = first_column; column <= last_column; ++column) {
+            size_t cell = (size_t)row * (size_t)index->columns + (size_t)column;
+            if (bounds[cell] == 0) {
+                continue;
+            }
+            long long gap = row_gap + axis_gap(x, column, index->columns, index->cell_size);
+            if (gap + delay >= bounds[cell]) {
+                largest = bounds[cell] > largest ? bounds[cell] : largest;
+                continue;
+            }
+
+            // The cell is visited in full, so its bound becomes exact.
+            int bound = 0;
+            emergency_record_t* next;
+            for (emergency_record_t* record = index->cells[cell]; record; record = next) {
+                next = record->cell_next;
+                if (record->descriptor->demand[type_id] <= 0) {
+                    continue;
+                }
+                long long dx = (long long)record->x - x;
+                long long dy = (long long)record->y - y;
+                long long score = (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy) + delay;
+                if (score < record->min_distance) {
+                    visit(record, score, arg);
+                }
+                bound = record->min_distance > bound ? record->min_distance : bound;
+            }
+            bounds[cell] = bound;
+            largest = bound > largest ? bound : largest;
+        }
+    }
+
+    if (first_column == 0 && first_row == 0 && last_column == index->columns - 1 && last_row == index->rows - 1) {
+        index->type_bounds[type_id] = largest;
+    }
+}
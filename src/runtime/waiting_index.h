@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stddef.h>
+
+struct emergency_record_t;
+
+// Cells along the longer side of the map.
+#ifndef WAITING_INDEX_SIDE
+#define WAITING_INDEX_SIDE 32
+#endif
+
+// Marks a record that is not in the index, or not in any cell.
+#define WAITING_INDEX_NONE (-1)
+
+// Index of the waiting records by the unit their min_distance was measured
+// to, so a unit that changes visits only the records that depend on it.
+// Every unit heads a list of the records whose nearest_unit it is, and one
+// more list holds those no unit could reach. The records that have a unit
+// also sit in a uniform grid of cells, and each cell keeps, per rescuer
+// type, an upper bound of the min_distance of its records that need the
+// type: a unit that becomes dispatchable skips every cell where it cannot
+// beat any of them. Lists and cells are intrusive doubly linked lists
+// through the records.
+typedef struct waiting_index_t {
+    int cell_size;
+    int columns;
+    int rows;
+    size_t type_count;
+    size_t unit_count;
+    struct emergency_record_t** cells; // rows * columns buckets
+    int* bounds;                       // [type * cells + cell], 0 when no record there needs the type
+    int* type_bounds;                  // per type: at least the largest of its cell bounds
+    struct emergency_record_t** lists; // per unit, then the records with none
+} waiting_index_t;
+
+// A width or height that is not positive gives a single cell.
+int waiting_index_init(waiting_index_t* index, int width, int height, size_t type_count, size_t unit_count);
+void waiting_index_destroy(waiting_index_t* index);
+
+// Files a record, or files it again after its nearest_unit or min_distance
+// changed; its position must not have.
+void waiting_index_file(waiting_index_t* index, struct emergency_record_t* record);
+// No-op for a record that is not indexed.
+void waiting_index_remove(waiting_index_t* index, struct emergency_record_t* record);
+
+// First record measured to the unit, or to none when unit is -1; the
+// others follow through nearest_next.
+struct emergency_record_t* waiting_index_first(const waiting_index_t* index, int unit);
+
+typedef void (*waiting_index_visit_t)(struct emergency_record_t* record, long long score, void* arg);
+
+// Calls visit, with the score, on every record with a unit that needs
+// type_id and that a unit of that type at (x, y), dispatchable in delay
+// seconds, would score below its min_distance. visit may lower the
+// record's min_distance and file it again, but must not remove it.
+void waiting_index_reach(waiting_index_t* index,
+                         int type_id,
+                         int x,
+                         int y,
+                         long long delay,
+                         waiting_index_visit_t visit,
+                         void* arg);